@@ -6,6 +6,8 @@
 #include <cstdint>
 #include <cstddef>
 
+#include "datatypes.hpp"
+
 /*
     The highest number of legal moves for a reachable position is 218,
     but there are certain custom legal positions with more moves:
@@ -17,10 +19,11 @@
 */
 constexpr uint16_t MAX_PSEUDO_MOVES = 280;
 
-typedef struct {
-    int move;
+// Packed so that a move list entry takes 6 bytes instead of 8
+typedef struct __attribute__((packed)) {
+    Move move;
     int score;
-} Move;
+} ScoredMove;
 
 template <typename T, std::size_t capacity>
 struct StaticVector {
@@ -29,6 +32,6 @@ struct StaticVector {
     uint16_t length = 0;
 };
 
-typedef StaticVector<Move, MAX_PSEUDO_MOVES> MoveList;
+typedef StaticVector<ScoredMove, MAX_PSEUDO_MOVES> MoveList;
 
 #endif  // STATICVECTOR_HPP
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 #include "chess/Board.hpp"
 #include "chess/makemove.hpp"
@@ -16,6 +17,7 @@
 #include "datatypes.hpp"
 #include "eval/evaluate.hpp"
 #include "search.hpp"
+#include "sharedhash.hpp"
 #include "timeman.hpp"
 
 /*
@@ -30,6 +32,26 @@ int UciHandler::get_value_from_line(const std::string& line, const std::string&
     return -1;
 }
 
+// (Re)allocates the hash table, in the SharedHash segment if one is set
+static void set_hash_table(HashTable& table, UciOptions* options) {
+    if (options->shared_hash.empty()) {
+        init_hash_table(table, options->hash_size);
+        return;
+    }
+
+    std::string error;
+    if (attach_shared_hash_table(table, options->hash_size, options->shared_hash, error)) {
+        std::cout << "info string Using shared hash " << options->shared_hash << " of "
+                  << (table.max_entries * sizeof(HashEntry) + 0xFFFFF) / 0x100000 << " MB"
+                  << std::endl;
+    } else {
+        std::cout << "info string Cannot share hash " << options->shared_hash << ": " << error
+                  << std::endl;
+        options->shared_hash.clear();
+        init_hash_table(table, options->hash_size);
+    }
+}
+
 /*
     Public methods
 */
@@ -40,96 +62,49 @@ UciHandler::UciHandler() {
 }
 
 // Handles go <> UCI commands
-// Supports: go wtime <> btime <> winc <> binc <>
+// Supports: go [ponder] wtime <> btime <> winc <> binc <> [movestogo <>]
+//           go ... searchmoves <move> <move> ...
 //           go movetime <>
 //           go depth <>
 //           go nodes <>
-//           go infinite (although no stop command at the moment, can only be stopped via keyboard
-//           interrupt)
+//           go infinite (until stop)
 void UciHandler::parse_go(Board& pos, HashTable& table, SearchInfo& info, UciOptions* options, const std::string& line) {
-    // int movestogo = 30;
-    int time = -1, movetime = -1;
-    int depth = -1, inc = 0, nodes = -1;
-    info.timeset = false;
-    info.nodesset = false;
-
-    if (line.find("infinite") != std::string::npos) {
-        // Nothing to handle
-    }
+    SearchLimits limits;
+    init_search_limits(limits);
 
     // Extract time control
-    if (pos.side == BLACK) {
-        inc = get_value_from_line(line, "binc");
-    }
-    if (pos.side == WHITE) {
-        inc = get_value_from_line(line, "winc");
-    }
-    if (pos.side == WHITE) {
-        time = get_value_from_line(line, "wtime");
-    }
-    if (pos.side == BLACK) {
-        time = get_value_from_line(line, "btime");
-    }
+    limits.wtime = get_value_from_line(line, "wtime");
+    limits.btime = get_value_from_line(line, "btime");
+    limits.winc = get_value_from_line(line, "winc");
+    limits.binc = get_value_from_line(line, "binc");
+    limits.movestogo = get_value_from_line(line, "movestogo");
 
     // Extract other "go" options
-    // movestogo is inaccurate and will not be supported in DR for the time being
-    // movestogo = get_value_from_line(line, "movestogo");
-    movetime = get_value_from_line(line, "movetime");
-    depth = get_value_from_line(line, "depth");
-    nodes = get_value_from_line(line, "nodes");
-
-    if (movetime != -1) {
-        time = movetime;
-        // movestogo = 1;
-    }
-
-    info.start_time = get_time_ms();
-    info.depth = depth;
-
-    // Time Management
-    if (movetime != -1) {
-        // No time management, directly use available time (- buffer)
-        info.timeset = true;
-        int buffered_time = std::max(movetime - (int)options->move_overhead, (int)options->move_overhead);
-        info.hard_stop_time = info.soft_stop_time = info.start_time + buffered_time;
-    } else if (time != -1) {
-        info.timeset = true;
-
-        // Get hard time limit
-        int buffered_time =
-            std::max((time + inc * 3 / 4) / 10 - (int)options->move_overhead, (int)options->move_overhead);
-        info.hard_stop_time = info.start_time + buffered_time;
-
-        // Get soft time limit based on current ply (phase)
-        buffered_time =
-            std::max(allocate_time(pos, time, inc) - (int)options->move_overhead, (int)options->move_overhead / 10);
-        // Prevent soft limit from exceeding hard limit
-        info.soft_stop_time =
-            std::min(info.start_time + buffered_time, info.hard_stop_time - (int)options->move_overhead);
-
-        // std::cout << "Current time: " << get_time_ms()
-        //    << " | Hard limit: " << info.hard_stop_time << " (" << info.hard_stop_time -
-        //    get_time_ms() << ") "
-        //    << " | Soft limit: " << info.soft_stop_time << " (" << info.soft_stop_time -
-        //    get_time_ms() << ") " << "\n";
-    }
-
-    if (depth == -1) {
-        info.depth = MAX_DEPTH;
-    }
-    if (nodes != -1) {
-        info.nodesset = true;
-        info.nodes_limit = nodes;
+    limits.movetime = get_value_from_line(line, "movetime");
+    limits.depth = get_value_from_line(line, "depth");
+    limits.nodes = get_value_from_line(line, "nodes");
+    limits.ponder = line.find("ponder") != std::string::npos;
+    limits.ponder_enabled = options->ponder;
+    limits.move_overhead = options->move_overhead;
+
+    // Restrict the root to the moves after searchmoves, up to the next go parameter
+    size_t searchmoves_pos = line.find("searchmoves ");
+    if (searchmoves_pos != std::string::npos) {
+        std::istringstream iss(line.substr(searchmoves_pos + 12));  // Skip "searchmoves "
+        std::string move_str;
+        while (iss >> move_str) {
+            Move move = parse_move(pos, move_str);
+            if (move == NO_MOVE) break;
+            add_searchmove(limits, move);
+        }
     }
 
-    // std::cout << "time: " << time << " start: " << info.start_time << " soft stop: " <<
-    // info.soft_stop_time << " hard stop: " << info.hard_stop_time << " depth: " <<
-    // (int)info.depth << " timeset: " << info.timeset << "\n"; std::cout << "nodeset: " <<
-    // info.nodesset << " | nodes limit: " << nodes << "\n";
+    info.multipv = options->multipv;
+    set_search_limits(pos, info, limits);
     search_position(pos, table, info);
 }
 
-void UciHandler::parse_position(Board& pos, const std::string& line) {
+void UciHandler::parse_position(Board& pos, UndoStack& undo, const std::string& line) {
     std::string input = line.substr(9);  // Skip "position "
 
     if (input.substr(0, 8) == "startpos") {
@@ -142,6 +117,7 @@ void UciHandler::parse_position(Board& pos, const std::string& line) {
             parse_fen(pos, input.substr(fen_pos + 4));  // Skip "fen "
         }
     }
+    reset_undo_stack(undo);
 
     size_t moves_pos = input.find("moves");
     if (moves_pos != std::string::npos) {
@@ -151,9 +127,9 @@ void UciHandler::parse_position(Board& pos, const std::string& line) {
             size_t space_pos = movelist_str.find(' ');
             std::string move_str =
                 (space_pos == std::string::npos) ? movelist_str : movelist_str.substr(0, space_pos);
-            int move = parse_move(pos, move_str);
+            Move move = parse_move(pos, move_str);
             if (move == NO_MOVE) break;
-            make_move(pos, move);
+            make_move(pos, undo, move);
 
             // Erase the processed move from movesPart
             movelist_str.erase(
@@ -170,43 +146,77 @@ void UciHandler::uci_loop(Board& pos, HashTable& table, SearchInfo& info, UciOpt
     options->hash_size = 16;
     options->threads = 1;
     options->move_overhead = 75;
+    options->ponder = false;
+    options->multipv = 1;
+    options->shared_hash.clear();
     init_hash_table(table, MB);
 
     parse_fen(pos, START_POS);
+    reset_undo_stack(info.undo);
+
+    // The search runs on its own thread so that stop and ponderhit can reach it
+    std::thread search_thread;
+    auto start_search = [&](const std::string& go_line) {
+        info.stop_requested = false;
+        info.pondering = go_line.find("ponder") != std::string::npos;
+        search_thread =
+            std::thread(&UciHandler::parse_go, this, std::ref(pos), std::ref(table), std::ref(info),
+                        options, go_line);
+    };
+    auto wait_for_search = [&]() {
+        if (search_thread.joinable()) {
+            search_thread.join();
+        }
+    };
 
     while (true) {
         std::getline(std::cin, line);
 
         if (line.empty()) continue;
 
+        // Commands handled while searching
         if (line.substr(0, 7) == "isready") {
-            std::cout << "readyok" << std::endl;
+            send_line("readyok");
+            continue;
+        } else if (line.substr(0, 9) == "ponderhit") {
+            info.pondering = false;
             continue;
-        } else if (line.substr(0, 8) == "position") {
-            parse_position(pos, line);
+        }
+
+        // Everything else stops the search (it may have no limits) and waits for its bestmove
+        if (search_thread.joinable()) {
+            info.stop_requested = true;
+        }
+        wait_for_search();
+
+        if (line.substr(0, 8) == "position") {
+            parse_position(pos, info.undo, line);
         } else if (line.substr(0, 10) == "ucinewgame") {
             clear_hash_table(table);
             parse_fen(pos, START_POS);
+            reset_undo_stack(info.undo);
         } else if (line.substr(0, 2) == "go") {
             if (line.substr(0, 8) == "go perft") {
-                // Parse depth from "go perft X" command
+                // Parse depth, optional thread count and hash size from "go perft X [T] [H]"
                 int depth = 0;
+                int threads = std::max(1u, std::thread::hardware_concurrency());
+                int hash_mb = 0;
                 size_t depth_pos = line.find("perft ");
                 if (depth_pos != std::string::npos) {
-                    try {
-                        depth = std::stoi(line.substr(depth_pos + 6));
-                    } catch (...) {
+                    std::istringstream iss(line.substr(depth_pos + 6));
+                    if (!(iss >> depth)) {
                         depth = 5;  // Fall back to default depth
                     }
+                    iss >> threads >> hash_mb;
                 }
                 // parse_fen(pos, CPW_POS5);
-                run_perft(pos, depth, true);
+                run_perft(pos, depth, threads, hash_mb, true);
             } else {
                 // Normal go command
-                parse_go(pos, table, info, options, line);
+                start_search(line);
             }
         } else if (line.substr(0, 3) == "run") {
-            parse_go(pos, table, info, options, "go infinite");
+            start_search("go infinite");
         } else if (line.substr(0, 4) == "quit") {
             info.quit = true;
             break;
@@ -219,6 +229,10 @@ void UciHandler::uci_loop(Board& pos, HashTable& table, SearchInfo& info, UciOpt
                     << std::endl;
             std::cout << "option name Threads type spin default 1 min 1 max 1" << std::endl;
             std::cout << "option name Move Overhead type spin default 75 min 0 max 5000" << std::endl;
+            std::cout << "option name Ponder type check default false" << std::endl;
+            std::cout << "option name MultiPV type spin default 1 min 1 max " << (int)MAX_MULTIPV
+                      << std::endl;
+            std::cout << "option name SharedHash type string default <empty>" << std::endl;
             std::cout << "uciok" << std::endl;
         } else if (line.substr(0, 26) == "setoption name Hash value ") {
             std::istringstream iss(line.substr(26));  // Extract the relevant substring
@@ -226,7 +240,7 @@ void UciHandler::uci_loop(Board& pos, HashTable& table, SearchInfo& info, UciOpt
             if (iss >> new_MB) {  // Attempt to read the integer
                 MB = CLAMP(new_MB, 1, (int)MAX_HASH);
                 options->hash_size = MB;
-                init_hash_table(table, MB);
+                set_hash_table(table, options);
                 std::cout << "info string Set Hash to " << MB << " MB" << std::endl;
             } else {
                 std::cout << "info string Invalid Hash value" << std::endl;
@@ -241,28 +255,54 @@ void UciHandler::uci_loop(Board& pos, HashTable& table, SearchInfo& info, UciOpt
             } else {
                 std::cout << "info string Invalid Move Overhead value" << std::endl;
             }
+        } else if (line.substr(0, 28) == "setoption name Ponder value ") {
+            options->ponder = line.substr(28, 4) == "true";
+            std::cout << "info string Set Ponder to " << (options->ponder ? "true" : "false")
+                      << std::endl;
+        } else if (line.substr(0, 29) == "setoption name MultiPV value ") {
+            std::istringstream iss(line.substr(29));
+            int new_multipv;
+            if (iss >> new_multipv) {
+                options->multipv = CLAMP(new_multipv, 1, (int)MAX_MULTIPV);
+                std::cout << "info string Set MultiPV to " << (int)options->multipv << std::endl;
+            } else {
+                std::cout << "info string Invalid MultiPV value" << std::endl;
+            }
+        } else if (line.substr(0, 31) == "setoption name SharedHash value") {
+            std::istringstream iss(line.substr(31));
+            std::string name;
+            iss >> name;
+            options->shared_hash = (name == "<empty>") ? "" : name;
+            set_hash_table(table, options);
+            if (options->shared_hash.empty()) {
+                std::cout << "info string Using a private hash table" << std::endl;
+            }
         } else if (line.substr(0, 5) == "print") {
             print_board(pos);
         } else if (line.substr(0, 4) == "eval") {
             int eval = evaluate_pos(pos);
             std::cout << "Static evaluation: " << eval << "cp\n";
         } else if (line.substr(0, 9) == "test") {
-            // TODO: Fix hash discrepancy
+            // Make and take an en passant capture, and check that the position is fully restored
             std::string test_fen =
                 "r1b1k1nr/ppqn1pbp/2pp2p1/4pP2/3PP3/3B1N2/PPP3PP/RNBQK2R w KQkq e6 0 1";
             parse_fen(pos, test_fen);
+            reset_undo_stack(info.undo);
             print_board(pos);
 
-            int move = 40899869;  // f5e6
+            Board before = pos;
+            Move move = parse_move(pos, "f5e6");
             // MoveList list = MoveList();
             // list.moves[0] = {move, 0};
             // list.length = 1;
-            // print_move_list(list, true);
-            make_move(pos, move);
+            // print_move_list(pos, list, true);
+            make_move(pos, info.undo, move);
             // print_board(pos);
 
-            take_move(pos);
+            take_move(pos, info.undo);
             print_board(pos);
+            std::cout << "Make/take test " << (check_boards(before, pos) ? "passed" : "failed")
+                      << "\n";
         }
 
         if (info.quit) break;
@@ -7,6 +7,8 @@
 #ifndef UCIHANDLER_HPP
 #define UCIHANDLER_HPP
 
+#include <string>
+
 #include "Board.hpp"
 #include "search.hpp"
 
@@ -14,17 +16,21 @@
 
 /*
 |------------|-----------------------------------------------------------------------|
-|  Commands  | Response. * denotes that the command blocks until no longer searching |
+|  Commands  | Response. * denotes that the command stops a running search first     |
 |------------|-----------------------------------------------------------------------|
 |        uci |           Outputs the engine name, authors, and all available options |
-|    isready | *           Responds with readyok when no longer searching a position |
+|    isready |                  Responds with readyok, even in the middle of a search |
 | ucinewgame | *  Resets the TT and any Hueristics to ensure determinism in searches |
 |  setoption | *     Sets a given option and reports that the option was set if done |
 |   position | *  Sets the board position via an optional FEN and optional move list |
 |         go | *       Searches the current position with the provided time controls |
+|            |   on a search thread; go ponder searches without limits until ponderhit |
+|  ponderhit |     The pondered move was played: the search goes on with its time limits |
 |       stop |            Signals the search threads to finish and report a bestmove |
 |       quit |             Exits the engine and any searches by killing the UCI loop |
-|      perft |            Custom command to compute PERFT(N) of the current position |
+|      perft |  Custom command to compute PERFT(N) of the current position (go perft |
+|            |   N [threads] [hash MB]); one thread per hardware core and no hash by |
+|            |                                                               default |
 |      print |         Custom command to print an ASCII view of the current position |
 |------------|-----------------------------------------------------------------------|
 */
@@ -34,6 +40,9 @@ typedef struct {
     uint32_t hash_size;     // type spin
     uint16_t threads;       // type spin
     uint16_t move_overhead; // type spin
+    bool ponder;            // type check
+    uint8_t multipv;        // type spin
+    std::string shared_hash; // type string (empty: private hash table)
 } UciOptions;
 
 class UciHandler {
@@ -41,7 +50,7 @@ class UciHandler {
     UciHandler();  // Blank constructor
 
     void parse_go(Board& pos, HashTable& table, SearchInfo& info, UciOptions* options, const std::string& line);
-    void parse_position(Board& pos, const std::string& line);
+    void parse_position(Board& pos, UndoStack& undo, const std::string& line);
     void uci_loop(Board& pos, HashTable& table, SearchInfo& info, UciOptions* options);
 
    private:
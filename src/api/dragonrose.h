@@ -0,0 +1,92 @@
+/* dragonrose.h */
+
+/*
+    C API of the embeddable engine (make lib: libdragonrose.a / libdragonrose.so).
+
+    Every DrEngine has its own position, search state and hash table, so any number of them can
+    search at the same time on different threads. One engine must not be used from two threads at
+    once, except for dr_stop and dr_ponderhit, which are meant to be called while dr_search runs.
+
+    Moves are the engine's 16-bit encoding (see src/chess/movegen.hpp); dr_move_to_uci turns one
+    into UCI notation. 0 is no move.
+*/
+
+#ifndef DRAGONROSE_H
+#define DRAGONROSE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct DrEngine DrEngine;
+
+/* Search limits, like the parameters of "go"; -1 where not given. No limits at all searches
+   until dr_stop. */
+typedef struct {
+    int wtime, btime; /* Clocks in ms */
+    int winc, binc;   /* Increments in ms */
+    int movestogo;    /* Moves to the next time control */
+    int movetime;     /* Fixed time in ms */
+    int depth;
+    int64_t nodes;
+    int ponder;              /* Non-zero: search without limits until dr_ponderhit */
+    const char* searchmoves; /* Space-separated UCI moves to restrict the root to, or NULL */
+} DrLimits;
+
+/* One finished iteration (one line of it with MultiPV). pv is only valid during the callback. */
+typedef struct {
+    int depth;
+    int seldepth;
+    int multipv;  /* Line number, 0 with MultiPV off */
+    int score_cp; /* From the side to move */
+    int mate;     /* Moves to mate, negative when getting mated; 0 if no mate was found (or if
+                     checkmated already: score_cp is -30000) */
+    uint64_t nodes;
+    uint64_t nps;
+    uint64_t time_ms;
+    int hashfull; /* Permill of the hash table written by this search, estimated */
+    const uint16_t* pv;
+    int pv_length;
+} DrInfo;
+
+typedef struct {
+    uint16_t best_move;
+    uint16_t ponder_move; /* Expected reply, 0 if unknown */
+    int depth;            /* Last completed iteration */
+    int score_cp;
+    int mate;
+    uint64_t nodes;
+} DrResult;
+
+typedef void (*DrInfoCallback)(const DrInfo* info, void* user_data);
+
+DrEngine* dr_engine_new(uint32_t hash_mb);
+void dr_engine_free(DrEngine* engine);
+
+void dr_set_hash(DrEngine* engine, uint32_t hash_mb);
+void dr_set_multipv(DrEngine* engine, int lines);
+void dr_set_move_overhead(DrEngine* engine, int ms);
+void dr_set_ponder(DrEngine* engine, int enabled);
+void dr_new_game(DrEngine* engine);
+
+/* fen: a FEN, or NULL / "startpos"; moves: space-separated UCI moves, or NULL.
+   Returns 0 if a move is not legal (the position is then left after the moves before it). */
+int dr_set_position(DrEngine* engine, const char* fen, const char* moves);
+
+void dr_limits_init(DrLimits* limits);
+/* Blocks until the search ends; on_info may be NULL */
+DrResult dr_search(DrEngine* engine, const DrLimits* limits, DrInfoCallback on_info,
+                   void* user_data);
+void dr_stop(DrEngine* engine);
+void dr_ponderhit(DrEngine* engine);
+
+/* Writes the move in UCI notation, e.g. "e7e8q", to out (at least 6 bytes) */
+void dr_move_to_uci(uint16_t move, char* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DRAGONROSE_H */
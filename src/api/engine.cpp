@@ -0,0 +1,303 @@
+// engine.cpp
+
+#include "engine.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "../chess/Board.hpp"
+#include "../chess/makemove.hpp"
+#include "../chess/moveio.hpp"
+#include "../search.hpp"
+#include "../ttable.hpp"
+
+struct Engine::State {
+    Board pos;
+    SearchInfo info;
+    HashTable table;
+    bool owns_table = true;  // false: a view of a SharedHashTable
+
+    uint8_t multipv = 1;
+    int move_overhead = 75;
+    bool ponder = false;
+
+    // Current search
+    const InfoCallback* on_info = nullptr;
+    DrResult result = {};
+};
+
+/*
+    Search callbacks
+*/
+
+static void report_to_engine(const SearchReport& report, void* data) {
+    Engine::State* state = static_cast<Engine::State*>(data);
+
+    DrInfo info;
+    info.depth = report.depth;
+    info.seldepth = report.seldepth;
+    info.multipv = report.multipv;
+    info.score_cp = report.score;
+    info.mate = report.mate;
+    info.nodes = report.nodes;
+    info.nps = report.nps;
+    info.time_ms = report.time;
+    info.hashfull = report.hashfull;
+    info.pv = report.pv->moves;
+    info.pv_length = report.pv->length;
+
+    // The first line is the result
+    if (report.multipv <= 1) {
+        state->result.depth = report.depth;
+        state->result.score_cp = report.score;
+        state->result.mate = report.mate;
+    }
+
+    if (state->on_info != nullptr && *state->on_info) {
+        (*state->on_info)(info);
+    }
+}
+
+static void bestmove_to_engine(Move best_move, Move ponder_move, void* data) {
+    Engine::State* state = static_cast<Engine::State*>(data);
+    state->result.best_move = best_move;
+    state->result.ponder_move = ponder_move;
+}
+
+/*
+    SharedHashTable
+*/
+
+struct SharedHashTable::Data {
+    HashTable table;
+};
+
+SharedHashTable::SharedHashTable(uint32_t hash_mb) : data(std::make_unique<Data>()) {
+    data->table.pTable = nullptr;
+    init_hash_table(data->table, std::clamp(hash_mb, (uint32_t)MIN_HASH, MAX_HASH));
+}
+
+SharedHashTable::~SharedHashTable() {
+    free_hash_table(data->table);
+}
+
+void SharedHashTable::clear() {
+    clear_hash_table(data->table);
+}
+
+/*
+    Engine
+*/
+
+static void init_engine_state(Engine::State& state) {
+    reset_board(state.pos);
+    parse_fen(state.pos, START_POS);
+    init_searchinfo(state.info);
+    reset_undo_stack(state.info.undo);
+    state.info.on_report = report_to_engine;
+    state.info.on_bestmove = bestmove_to_engine;
+    state.info.callback_data = &state;
+}
+
+Engine::Engine(uint32_t hash_mb) : state(std::make_unique<State>()) {
+    init_engine_state(*state);
+    state->table.pTable = nullptr;
+    init_hash_table(state->table, std::clamp(hash_mb, (uint32_t)MIN_HASH, MAX_HASH));
+}
+
+Engine::Engine(SharedHashTable& shared_table) : state(std::make_unique<State>()) {
+    init_engine_state(*state);
+
+    // Same entries and age (the shared table does not search, so its own age is free to count
+    // the searches of every engine), own counters
+    state->table = shared_table.data->table;
+    state->table.num_entries = 0;
+    state->table.new_write = 0;
+    state->table.table_age = 0;
+    state->table.shared_age = &shared_table.data->table.table_age;
+    state->owns_table = false;
+}
+
+Engine::~Engine() {
+    if (state->owns_table) {
+        free_hash_table(state->table);
+    }
+}
+
+void Engine::set_hash(uint32_t hash_mb) {
+    if (state->owns_table) {
+        init_hash_table(state->table, std::clamp(hash_mb, (uint32_t)MIN_HASH, MAX_HASH));
+    }
+}
+
+void Engine::set_multipv(int lines) {
+    state->multipv = std::clamp(lines, 1, (int)MAX_MULTIPV);
+}
+
+void Engine::set_move_overhead(int ms) {
+    state->move_overhead = std::clamp(ms, 0, 5000);
+}
+
+void Engine::set_ponder(bool enabled) {
+    state->ponder = enabled;
+}
+
+void Engine::new_game() {
+    if (state->owns_table) {
+        clear_hash_table(state->table);
+    }
+    parse_fen(state->pos, START_POS);
+    reset_undo_stack(state->info.undo);
+}
+
+bool Engine::set_position(const std::string& fen, const std::vector<std::string>& moves) {
+    parse_fen(state->pos, (fen.empty() || fen == "startpos") ? std::string(START_POS) : fen);
+    reset_undo_stack(state->info.undo);
+
+    for (const std::string& move_str : moves) {
+        Move move = parse_move(state->pos, move_str);
+        if (move == NO_MOVE || !make_move(state->pos, state->info.undo, move)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DrResult Engine::search(const DrLimits& limits, const InfoCallback& on_info) {
+    SearchLimits search_limits;
+    init_search_limits(search_limits);
+    search_limits.wtime = limits.wtime;
+    search_limits.btime = limits.btime;
+    search_limits.winc = limits.winc;
+    search_limits.binc = limits.binc;
+    search_limits.movestogo = limits.movestogo;
+    search_limits.movetime = limits.movetime;
+    search_limits.depth = std::min(limits.depth, (int)MAX_DEPTH);
+    search_limits.nodes = limits.nodes;
+    search_limits.ponder = limits.ponder != 0;
+    search_limits.ponder_enabled = state->ponder;
+    search_limits.move_overhead = state->move_overhead;
+
+    if (limits.searchmoves != nullptr) {
+        std::istringstream iss(limits.searchmoves);
+        std::string move_str;
+        while (iss >> move_str) {
+            Move move = parse_move(state->pos, move_str);
+            if (move != NO_MOVE) {
+                add_searchmove(search_limits, move);
+            }
+        }
+    }
+
+    state->result = {};
+    state->on_info = &on_info;
+    state->info.multipv = state->multipv;
+    state->info.stop_requested = false;
+    state->info.pondering = search_limits.ponder;
+    set_search_limits(state->pos, state->info, search_limits);
+
+    search_position(state->pos, state->table, state->info);
+
+    state->on_info = nullptr;
+    state->result.nodes = state->info.nodes;
+    return state->result;
+}
+
+void Engine::stop() {
+    state->info.stop_requested = true;
+}
+
+void Engine::ponderhit() {
+    state->info.pondering = false;
+}
+
+std::string Engine::move_to_uci(uint16_t move) {
+    return print_move(move);
+}
+
+/*
+    C API
+*/
+
+struct DrEngine {
+    Engine engine;
+    explicit DrEngine(uint32_t hash_mb) : engine(hash_mb) {}
+};
+
+extern "C" {
+
+DrEngine* dr_engine_new(uint32_t hash_mb) {
+    return new DrEngine(hash_mb);
+}
+
+void dr_engine_free(DrEngine* engine) {
+    delete engine;
+}
+
+void dr_set_hash(DrEngine* engine, uint32_t hash_mb) {
+    engine->engine.set_hash(hash_mb);
+}
+
+void dr_set_multipv(DrEngine* engine, int lines) {
+    engine->engine.set_multipv(lines);
+}
+
+void dr_set_move_overhead(DrEngine* engine, int ms) {
+    engine->engine.set_move_overhead(ms);
+}
+
+void dr_set_ponder(DrEngine* engine, int enabled) {
+    engine->engine.set_ponder(enabled != 0);
+}
+
+void dr_new_game(DrEngine* engine) {
+    engine->engine.new_game();
+}
+
+int dr_set_position(DrEngine* engine, const char* fen, const char* moves) {
+    std::vector<std::string> move_list;
+    if (moves != nullptr) {
+        std::istringstream iss(moves);
+        std::string move_str;
+        while (iss >> move_str) {
+            move_list.push_back(move_str);
+        }
+    }
+    return engine->engine.set_position(fen != nullptr ? fen : "startpos", move_list);
+}
+
+void dr_limits_init(DrLimits* limits) {
+    limits->wtime = limits->btime = -1;
+    limits->winc = limits->binc = -1;
+    limits->movestogo = -1;
+    limits->movetime = -1;
+    limits->depth = -1;
+    limits->nodes = -1;
+    limits->ponder = 0;
+    limits->searchmoves = nullptr;
+}
+
+DrResult dr_search(DrEngine* engine, const DrLimits* limits, DrInfoCallback on_info,
+                   void* user_data) {
+    if (on_info == nullptr) {
+        return engine->engine.search(*limits);
+    }
+    return engine->engine.search(
+        *limits, [on_info, user_data](const DrInfo& info) { on_info(&info, user_data); });
+}
+
+void dr_stop(DrEngine* engine) {
+    engine->engine.stop();
+}
+
+void dr_ponderhit(DrEngine* engine) {
+    engine->engine.ponderhit();
+}
+
+void dr_move_to_uci(uint16_t move, char* out) {
+    std::string uci = print_move(move);
+    std::memcpy(out, uci.c_str(), uci.size() + 1);
+}
+
+}  // extern "C"
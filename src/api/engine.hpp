@@ -0,0 +1,72 @@
+// engine.hpp
+
+/*
+    C++ API of the embeddable engine (make lib). An Engine owns its position, search state and
+    hash table; there is no shared mutable state, so separate Engines can search concurrently.
+    search() blocks; stop() and ponderhit() may be called from another thread while it runs.
+    Engines may also share one SharedHashTable, and SessionManager (session.hpp) runs many of
+    them on a pool of worker threads.
+    The limit, info and result types are shared with the C API (dragonrose.h).
+*/
+
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dragonrose.h"
+
+typedef std::function<void(const DrInfo& info)> InfoCallback;
+
+// A hash table that several Engines search with at once, on any threads. Entries are read and
+// written without locks (see HashEntry); it must outlive the Engines using it.
+class SharedHashTable {
+   public:
+    explicit SharedHashTable(uint32_t hash_mb);
+    ~SharedHashTable();
+    SharedHashTable(const SharedHashTable&) = delete;
+    SharedHashTable& operator=(const SharedHashTable&) = delete;
+
+    void clear();  // Only while no Engine using it is searching
+
+    struct Data;  // Defined in engine.cpp
+
+   private:
+    friend class Engine;
+    std::unique_ptr<Data> data;
+};
+
+class Engine {
+   public:
+    explicit Engine(uint32_t hash_mb = 16);
+    explicit Engine(SharedHashTable& shared_table);  // set_hash and new_game leave the table alone
+    ~Engine();
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    void set_hash(uint32_t hash_mb);
+    void set_multipv(int lines);
+    void set_move_overhead(int ms);
+    void set_ponder(bool enabled);
+    void new_game();  // Clears the hash table
+
+    // fen: a FEN or "startpos"; returns false if a move is not legal
+    bool set_position(const std::string& fen, const std::vector<std::string>& moves = {});
+
+    DrResult search(const DrLimits& limits, const InfoCallback& on_info = nullptr);
+    void stop();
+    void ponderhit();
+
+    static std::string move_to_uci(uint16_t move);
+
+    struct State;  // Defined in engine.cpp
+
+   private:
+    std::unique_ptr<State> state;
+};
+
+#endif  // ENGINE_HPP
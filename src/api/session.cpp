@@ -0,0 +1,282 @@
+// session.cpp
+
+#include "session.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "../timeman.hpp"
+
+struct Session {
+    explicit Session(uint32_t hash_mb) : engine(hash_mb) {}
+    explicit Session(SharedHashTable& shared_table) : engine(shared_table) {}
+
+    Engine engine;
+    bool busy = false;        // Search queued or running
+    bool searching = false;   // Search running on a worker
+    bool destroying = false;  // In destroy_session: takes no new searches
+    std::atomic<bool> stop_pending = false;
+
+    // Queued search
+    DrLimits limits;
+    std::string searchmoves;  // limits.searchmoves points here
+    uint64_t queued_time = 0;
+    ResultCallback on_done;
+    InfoCallback on_info;
+
+    DrResult result = {};  // Of the last search
+};
+
+struct SessionManager::Impl {
+    std::unique_ptr<SharedHashTable> shared_table;
+    std::vector<std::thread> workers;
+
+    // Guards everything below, and every Session field other than engine and stop_pending
+    mutable std::mutex mutex;
+    std::condition_variable work_ready;   // Queue not empty, or quitting
+    std::condition_variable search_done;  // Some session stopped being busy
+    std::deque<SessionId> queue;
+    std::unordered_map<SessionId, std::unique_ptr<Session>> sessions;
+    SessionId next_id = 1;
+    bool quit = false;
+
+    Session* find(SessionId id) {
+        auto it = sessions.find(id);
+        return it == sessions.end() ? nullptr : it->second.get();
+    }
+
+    void worker_loop();
+};
+
+// Takes the time spent in the queue off a limit given in ms (-1: not given)
+static inline int charge_queue_time(int limit, uint64_t waited) {
+    if (limit < 0) {
+        return limit;
+    }
+    return std::max(1, limit - static_cast<int>(waited));
+}
+
+void SessionManager::Impl::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        work_ready.wait(lock, [this] { return quit || !queue.empty(); });
+        if (quit) {
+            return;
+        }
+
+        const SessionId id = queue.front();
+        queue.pop_front();
+        Session& session = *sessions.at(id);  // Not destroyed while busy
+        session.searching = true;
+
+        DrLimits limits = session.limits;
+        const uint64_t waited = get_time_ms() - session.queued_time;
+        limits.wtime = charge_queue_time(limits.wtime, waited);
+        limits.btime = charge_queue_time(limits.btime, waited);
+        limits.movetime = charge_queue_time(limits.movetime, waited);
+
+        lock.unlock();
+
+        // A stop can arrive before the search has started listening for it: repeat it after
+        // every iteration until the search ends
+        DrResult result = session.engine.search(limits, [&session](const DrInfo& info) {
+            if (session.stop_pending) {
+                session.engine.stop();
+            }
+            if (session.on_info) {
+                session.on_info(info);
+            }
+        });
+
+        lock.lock();
+        session.result = result;
+        session.busy = false;
+        session.searching = false;
+        ResultCallback on_done = std::move(session.on_done);
+        session.on_done = nullptr;
+        session.on_info = nullptr;
+        search_done.notify_all();
+
+        if (on_done) {
+            lock.unlock();
+            on_done(id, result);
+            lock.lock();
+        }
+    }
+}
+
+SessionManager::SessionManager(int workers, uint32_t shared_hash_mb)
+    : impl(std::make_unique<Impl>()) {
+    if (shared_hash_mb > 0) {
+        impl->shared_table = std::make_unique<SharedHashTable>(shared_hash_mb);
+    }
+
+    if (workers <= 0) {
+        workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < workers; ++i) {
+        impl->workers.emplace_back(&Impl::worker_loop, impl.get());
+    }
+}
+
+SessionManager::~SessionManager() {
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->quit = true;
+        for (auto& [id, session] : impl->sessions) {
+            if (session->searching) {
+                session->stop_pending = true;
+                session->engine.stop();
+            }
+        }
+    }
+    impl->work_ready.notify_all();
+
+    for (std::thread& worker : impl->workers) {
+        worker.join();
+    }
+}
+
+SessionId SessionManager::create_session(uint32_t hash_mb) {
+    std::unique_ptr<Session> session = impl->shared_table
+                                           ? std::make_unique<Session>(*impl->shared_table)
+                                           : std::make_unique<Session>(hash_mb);
+
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    const SessionId id = impl->next_id++;
+    impl->sessions.emplace(id, std::move(session));
+    return id;
+}
+
+void SessionManager::destroy_session(SessionId id) {
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    Session* session = impl->find(id);
+    if (session == nullptr) {
+        return;
+    }
+
+    // on_done may have queued another search by the time this wakes up (start_search refuses
+    // new ones from here on)
+    session->destroying = true;
+    while (session->busy) {
+        if (!session->searching) {
+            impl->queue.erase(std::find(impl->queue.begin(), impl->queue.end(), id));
+            session->busy = false;
+            break;
+        }
+        session->stop_pending = true;
+        session->engine.stop();
+        impl->search_done.wait(lock);
+    }
+
+    // Free the engine (and its hash table) outside the lock
+    std::unique_ptr<Session> owned = std::move(impl->sessions.at(id));
+    impl->sessions.erase(id);
+    lock.unlock();
+}
+
+size_t SessionManager::session_count() const {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    return impl->sessions.size();
+}
+
+int SessionManager::worker_count() const {
+    return static_cast<int>(impl->workers.size());
+}
+
+bool SessionManager::set_position(SessionId id, const std::string& fen,
+                                  const std::vector<std::string>& moves) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    Session* session = impl->find(id);
+    if (session == nullptr || session->busy) {
+        return false;
+    }
+    return session->engine.set_position(fen, moves);
+}
+
+bool SessionManager::new_game(SessionId id) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    Session* session = impl->find(id);
+    if (session == nullptr || session->busy) {
+        return false;
+    }
+    session->engine.new_game();
+    return true;
+}
+
+bool SessionManager::set_multipv(SessionId id, int lines) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    Session* session = impl->find(id);
+    if (session == nullptr || session->busy) {
+        return false;
+    }
+    session->engine.set_multipv(lines);
+    return true;
+}
+
+bool SessionManager::set_move_overhead(SessionId id, int ms) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    Session* session = impl->find(id);
+    if (session == nullptr || session->busy) {
+        return false;
+    }
+    session->engine.set_move_overhead(ms);
+    return true;
+}
+
+bool SessionManager::start_search(SessionId id, const DrLimits& limits,
+                                  const ResultCallback& on_done, const InfoCallback& on_info) {
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        Session* session = impl->find(id);
+        if (session == nullptr || session->busy || session->destroying) {
+            return false;
+        }
+
+        session->busy = true;
+        session->stop_pending = false;
+        session->limits = limits;
+        session->searchmoves = limits.searchmoves != nullptr ? limits.searchmoves : "";
+        session->limits.searchmoves =
+            limits.searchmoves != nullptr ? session->searchmoves.c_str() : nullptr;
+        session->queued_time = get_time_ms();
+        session->on_done = on_done;
+        session->on_info = on_info;
+        impl->queue.push_back(id);
+    }
+    impl->work_ready.notify_one();
+    return true;
+}
+
+void SessionManager::stop(SessionId id) {
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    Session* session = impl->find(id);
+    if (session == nullptr || !session->busy) {
+        return;
+    }
+
+    session->stop_pending = true;
+    if (session->searching) {
+        session->engine.stop();
+    }
+}
+
+bool SessionManager::wait(SessionId id, DrResult* result) {
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    Session* session = impl->find(id);
+    if (session == nullptr) {
+        return false;
+    }
+
+    impl->search_done.wait(lock, [session] { return !session->busy; });
+    if (result != nullptr) {
+        *result = session->result;
+    }
+    return true;
+}
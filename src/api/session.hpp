@@ -0,0 +1,64 @@
+// session.hpp
+
+/*
+    Many independent games in one process (make lib). A SessionManager runs a fixed pool of
+    worker threads for any number of sessions, each an Engine with its own position and search
+    state. start_search() queues a search and returns at once; the next free worker runs it and
+    hands the result to the session's callback. Sessions either have a hash table each or all
+    share one SharedHashTable.
+*/
+
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+
+typedef int SessionId;
+
+typedef std::function<void(SessionId id, const DrResult& result)> ResultCallback;
+
+class SessionManager {
+   public:
+    // workers: 0 for one per hardware thread
+    // shared_hash_mb: one hash table for all sessions, or 0 for a table per session
+    explicit SessionManager(int workers = 0, uint32_t shared_hash_mb = 0);
+    ~SessionManager();  // Stops the running searches; queued ones are dropped
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    SessionId create_session(uint32_t hash_mb = 16);  // hash_mb: unused with a shared table
+    void destroy_session(SessionId id);               // Stops its search first
+    size_t session_count() const;
+    int worker_count() const;
+
+    // These fail for unknown sessions and while the session has a search queued or running
+    bool set_position(SessionId id, const std::string& fen,
+                      const std::vector<std::string>& moves = {});
+    bool new_game(SessionId id);
+    bool set_multipv(SessionId id, int lines);
+    bool set_move_overhead(SessionId id, int ms);
+
+    // Queues a search. The time it waits for a worker is taken off the clocks and movetime.
+    // on_done and on_info are called on the worker thread; on_done may start the next search.
+    bool start_search(SessionId id, const DrLimits& limits, const ResultCallback& on_done = nullptr,
+                      const InfoCallback& on_info = nullptr);
+    void stop(SessionId id);  // A search stopped before it ran still returns a depth 1 move
+
+    // Blocks until the session has no search queued or running; false for unknown sessions.
+    // The session must not be destroyed meanwhile.
+    bool wait(SessionId id, DrResult* result = nullptr);
+
+    struct Impl;  // Defined in session.cpp
+
+   private:
+    std::unique_ptr<Impl> impl;
+};
+
+#endif  // SESSION_HPP
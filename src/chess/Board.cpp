@@ -5,6 +5,7 @@
 #include <cstdlib>  // atoi()
 #include <iostream>
 
+#include "attack.hpp"
 #include "bitboard.hpp"
 #include "movegen.hpp"
 #include "moveio.hpp"
@@ -35,30 +36,27 @@ void reset_board(Board& pos) {
     pos.ply = 0;
     pos.his_ply = 0;
     pos.hash_key = 0ULL;
+    pos.checkers = 0ULL;
+    pos.pinned = 0ULL;
+}
 
-    for (int index = 0; index < 2; ++index) {
-        for (int ply = 0; ply < MAX_DEPTH; ++ply) {
-            pos.killer_moves[index][ply] = 0;
-        }
-    }
-    for (int pce = 0; pce < 13; ++pce) {
-        for (int sq = 0; sq < 64; ++sq) {
-            pos.history_moves[pce][sq] = 0;
-        }
-    }
-
-    pos.PV_array.length = 0;
-    pos.PV_array.score = -INF_BOUND;
-    for (int i = 0; i < MAX_DEPTH; ++i) {
-        pos.PV_array.moves[i] = 0;  // NO_MOVE
-    }
-
-    for (UndoBox& box : pos.move_history) {
+// Clears the undo history, so that stale keys are not mistaken for repetitions
+void reset_undo_stack(UndoStack& undo) {
+    for (UndoBox& box : undo.move_history) {
+        box.move = 0;  // NO_MOVE
+#ifdef COPY_MAKE
+        reset_board(box.pos);
+#else
+        box.captured = EMPTY;
         box.castle_perms = 0;
         box.enpas = 0;
         box.fifty_move = 0;
-        box.hash_key = 0ULL;
-        box.move = 0;  // NO_MOVE
+        box.checkers = 0ULL;
+        box.pinned = 0ULL;
+#endif
+    }
+    for (uint64_t& key : undo.key_history) {
+        key = 0ULL;
     }
 }
 
@@ -242,6 +240,7 @@ void parse_fen(Board& pos, const std::string FEN) {
     pos.hash_key = generate_hash_key(pos);  // Get Zobrist key for the position
 
     update_vars(pos);
+    update_check_info(pos);
 }
 
 /*
@@ -280,7 +279,7 @@ void print_board(const Board& pos) {
     std::cout << std::dec;  // Reset output to base 10
 }
 
-void print_move_history(const Board& pos) {
+void print_move_history(const Board& pos, const UndoStack& undo) {
     if (pos.his_ply == 0) {
         std::cout << "print_move_history() warning: No move history available.\n";
         return;
@@ -288,7 +287,7 @@ void print_move_history(const Board& pos) {
 
     std::cout << "Move history: ";
     for (int i = 0; i < pos.his_ply; ++i) {
-        std::cout << print_move(pos.move_history[i].move) << " ";
+        std::cout << print_move(undo.move_history[i].move) << " ";
     }
     std::cout << "\n";
 }
@@ -338,9 +337,10 @@ bool check_boards(const Board& pos1, const Board& pos2) {
     // Compare other attributes
     if (pos1.side != pos2.side || pos1.enpas != pos2.enpas ||
         pos1.castle_perms != pos2.castle_perms || pos1.fifty_move != pos2.fifty_move ||
-        pos1.ply != pos2.ply || pos1.his_ply != pos2.his_ply || pos1.hash_key != pos2.hash_key) {
-        std::cout
-            << "Either side, enpas, castle_perms, fiftymove, ply, hisply or hashkey is different\n";
+        pos1.ply != pos2.ply || pos1.his_ply != pos2.his_ply || pos1.hash_key != pos2.hash_key ||
+        pos1.checkers != pos2.checkers || pos1.pinned != pos2.pinned) {
+        std::cout << "Either side, enpas, castle_perms, fiftymove, ply, hisply, hashkey, checkers "
+                     "or pinned is different\n";
         return false;
     }
 
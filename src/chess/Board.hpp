@@ -16,14 +16,7 @@ typedef unsigned long long Bitboard;
 
 #define START_POS "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
 
-typedef struct {
-    int move;
-    int castle_perms;
-    int enpas;
-    int fifty_move;
-    uint64_t hash_key;
-} UndoBox;
-
+// Compact position core. Kept free of history and search tables so that copies are cheap
 typedef struct {
     uint8_t pieces[64];  // Square -> Piece
     Bitboard bitboards[13];
@@ -37,22 +30,52 @@ typedef struct {
     uint8_t fifty_move;  // Counter for 50-move rule
 
     uint8_t ply;
-    uint8_t his_ply;
+    uint16_t his_ply;
     uint64_t hash_key;
-    UndoBox move_history[2048];  // Fixed indices, easier to manage than vector
 
-    int killer_moves[2][64];    // killer moves [id][ply]
-    int history_moves[13][64];  // history moves [piece][square]
-    PVLine PV_array;            // Stores the final best PV after every depth
+    // Kept up to date by make_move / parse_fen (see update_check_info in attack.hpp)
+    Bitboard checkers;  // Enemy pieces giving check to the side to move
+    Bitboard pinned;    // Side to move's pieces pinned to its king
 } Board;
 
+static_assert(sizeof(Board) <= 256, "Board should stay small enough to copy cheaply");
+
+// Undo information for one move. Build with COPY_MAKE to save whole copies of the position
+// (copy-make) instead of the state needed to unmake the move (make/unmake).
+typedef struct {
+    Move move;
+#ifdef COPY_MAKE
+    Board pos;
+#else
+    uint8_t captured;  // Captured piece, since moves don't encode it
+    uint8_t castle_perms;
+    uint8_t enpas;
+    uint8_t fifty_move;
+    Bitboard checkers;
+    Bitboard pinned;
+#endif
+} UndoBox;
+
+// Undo history of the game and the current search line, indexed by his_ply.
+// Owned by the searcher (see SearchInfo) rather than the board.
+typedef struct {
+    UndoBox move_history[MAX_GAME_MOVES];  // Fixed indices, easier to manage than vector
+    uint64_t key_history[MAX_GAME_MOVES];  // Hash keys on their own, for repetition scans
+} UndoStack;
+
+// Hash key of the position before the move at the given history index was made
+static inline uint64_t history_key(const UndoStack& undo, int index) {
+    return undo.key_history[index];
+}
+
 // Board functions
 void reset_board(Board& pos);
 void update_vars(Board& pos);
 void parse_fen(Board& pos, const std::string FEN);
 
 void print_board(const Board& pos);
-void print_move_history(const Board& pos);
+void reset_undo_stack(UndoStack& undo);
+void print_move_history(const Board& pos, const UndoStack& undo);
 bool check_boards(const Board& pos1, const Board& pos2);
 
 #endif  // BOARD_HPP
\ No newline at end of file
@@ -33,6 +33,62 @@ static inline bool is_square_attacked(const Board& pos, uint8_t sq, uint8_t side
     return false;
 }
 
+// Check if a square would be attacked by the side not to move, given a hypothetical occupancy
+// and ignoring the enemy pieces in `removed` (e.g. one about to be captured)
+static inline bool is_square_attacked_after(const Board& pos, uint8_t sq, Bitboard occupancy,
+                                            Bitboard removed) {
+    uint8_t us = pos.side;
+    Bitboard enemies = pos.occupancies[us ^ 1] & ~removed;
+    Bitboard enemy_pawns = (us == WHITE) ? pos.bitboards[bP] : pos.bitboards[wP];
+    Bitboard enemy_knights = (us == WHITE) ? pos.bitboards[bN] : pos.bitboards[wN];
+    Bitboard enemy_king = (us == WHITE) ? pos.bitboards[bK] : pos.bitboards[wK];
+    Bitboard enemy_diagonal = (us == WHITE) ? (pos.bitboards[bB] | pos.bitboards[bQ])
+                                            : (pos.bitboards[wB] | pos.bitboards[wQ]);
+    Bitboard enemy_straight = (us == WHITE) ? (pos.bitboards[bR] | pos.bitboards[bQ])
+                                            : (pos.bitboards[wR] | pos.bitboards[wQ]);
+
+    return ((pawn_attacks[us][sq] & enemy_pawns) | (knight_attacks[sq] & enemy_knights) |
+            (king_attacks[sq] & enemy_king) |
+            (get_bishop_attacks(sq, occupancy) & enemy_diagonal) |
+            (get_rook_attacks(sq, occupancy) & enemy_straight)) &
+           enemies;
+}
+
+// Recompute the enemy pieces checking the side to move and the side to move's pinned pieces
+static inline void update_check_info(Board& pos) {
+    uint8_t us = pos.side;
+    uint8_t king_sq = pos.king_sq[us];
+    if (king_sq == NO_SQ) {
+        pos.checkers = pos.pinned = 0ULL;
+        return;
+    }
+
+    Bitboard enemy_pawns = (us == WHITE) ? pos.bitboards[bP] : pos.bitboards[wP];
+    Bitboard enemy_knights = (us == WHITE) ? pos.bitboards[bN] : pos.bitboards[wN];
+    Bitboard enemy_diagonal = (us == WHITE) ? (pos.bitboards[bB] | pos.bitboards[bQ])
+                                            : (pos.bitboards[wB] | pos.bitboards[wQ]);
+    Bitboard enemy_straight = (us == WHITE) ? (pos.bitboards[bR] | pos.bitboards[bQ])
+                                            : (pos.bitboards[wR] | pos.bitboards[wQ]);
+
+    // A king can never give check, so it is left out
+    pos.checkers = (pawn_attacks[us][king_sq] & enemy_pawns) |
+                   (knight_attacks[king_sq] & enemy_knights) |
+                   (get_bishop_attacks(king_sq, pos.occupancies[BOTH]) & enemy_diagonal) |
+                   (get_rook_attacks(king_sq, pos.occupancies[BOTH]) & enemy_straight);
+
+    // Enemy sliders lined up with the king on an empty board. Exactly one blocker between the
+    // two, if it is ours, is pinned
+    Bitboard snipers = (get_bishop_attacks(king_sq, 0ULL) & enemy_diagonal) |
+                       (get_rook_attacks(king_sq, 0ULL) & enemy_straight);
+    pos.pinned = 0ULL;
+    while (snipers) {
+        Bitboard blockers = between_masks[king_sq][pop_ls1b(snipers)] & pos.occupancies[BOTH];
+        if (count_bits(blockers) == 1) {
+            pos.pinned |= blockers & pos.occupancies[us];
+        }
+    }
+}
+
 static inline Bitboard get_piece_attacks(const Board& pos, uint8_t pce, uint8_t sq) {
     if (piece_type[pce] == PAWN) return pawn_attacks[piece_col[pce]][sq];
     if (piece_type[pce] == KNIGHT) return knight_attacks[sq];
@@ -3,32 +3,26 @@
 #ifndef ATTACKGEN_HPP
 #define ATTACKGEN_HPP
 
+#include <array>
+
 #include "../datatypes.hpp"
 
-// Attack tables
-extern Bitboard pawn_attacks[2][64];      // pawn attacks table [side][square]
-extern Bitboard knight_attacks[64];       // knight attacks table [square]
-extern Bitboard king_attacks[64];         // king attacks table [square]
-extern Bitboard bishop_masks[64];         // bishop attack masks
-extern Bitboard rook_masks[64];           // rook attack masks
-extern Bitboard bishop_attacks[64][512];  // bishop attacks table [square][occupancies]
-extern Bitboard rook_attacks[64][4096];   // rook attacks table [square][occupancies]
-
-// Functions
-Bitboard mask_bishop_attacks(int sq);
-Bitboard mask_rook_attacks(int sq);
-Bitboard bishop_attacks_on_the_fly(int sq, Bitboard blockers);
-Bitboard rook_attacks_on_the_fly(int sq, Bitboard blockers);
-
-Bitboard get_bishop_attacks(int sq, Bitboard occupancy);
-Bitboard get_rook_attacks(int sq, Bitboard occupancy);
-Bitboard get_queen_attacks(int sq, Bitboard occupancy);
-
-void init_leapers_attacks();
-void init_sliders_attacks(int bishop);
-Bitboard set_occupancy(int index, int bits_in_mask, Bitboard attack_mask);
-
-enum { IS_BISHOP, IS_ROOK };
+#ifdef USE_PEXT
+#ifndef __BMI2__
+#error "USE_PEXT requires a BMI2 target (e.g. -mbmi2 or -march=native on a BMI2 CPU)"
+#endif
+#include <immintrin.h>
+#endif
+
+/*
+    Slider attack backends, selected at build time:
+      (default)    Plain magic bitboards. One fixed-size slice per square (~2.3 MB)
+      FANCY_MAGIC  Fancy magic bitboards. Slices sized per square in one shared table (~840 KB)
+      USE_PEXT     BMI2 PEXT indexing into the same shared table as FANCY_MAGIC
+*/
+#if defined(USE_PEXT) || defined(FANCY_MAGIC)
+#define SHARED_SLIDER_TABLE
+#endif
 
 /*
      not A file          not H file         not HG files      not AB files
@@ -101,4 +95,186 @@ constexpr uint64_t bishop_magic_numbers[64] = {
     0xa010109502200ULL,    0x4a02012000ULL,       0x500201010098b028ULL, 0x8040002811040900ULL,
     0x28000010020204ULL,   0x6000020202d0240ULL,  0x8918844842082200ULL, 0x4010011029020020ULL};
 
+/*
+    Attack masks, generated at compile time
+*/
+
+// generate pawn attacks
+constexpr Bitboard mask_pawn_attacks(int side, int sq) {
+    Bitboard attacks = 0ULL;
+    Bitboard bitboard = 1ULL << sq;
+
+    // White pawns
+    if (!side) {
+        if ((bitboard >> 7) & not_a_file) attacks |= (bitboard >> 7);
+        if ((bitboard >> 9) & not_h_file) attacks |= (bitboard >> 9);
+    }
+    // Black pawns
+    else {
+        if ((bitboard << 7) & not_h_file) attacks |= (bitboard << 7);
+        if ((bitboard << 9) & not_a_file) attacks |= (bitboard << 9);
+    }
+
+    return attacks;
+}
+
+// generate knight attacks
+constexpr Bitboard mask_knight_attacks(int sq) {
+    Bitboard attacks = 0ULL;
+    Bitboard bitboard = 1ULL << sq;
+
+    if ((bitboard >> 17) & not_h_file) attacks |= (bitboard >> 17);
+    if ((bitboard >> 15) & not_a_file) attacks |= (bitboard >> 15);
+    if ((bitboard >> 10) & not_hg_file) attacks |= (bitboard >> 10);
+    if ((bitboard >> 6) & not_ab_file) attacks |= (bitboard >> 6);
+    if ((bitboard << 17) & not_a_file) attacks |= (bitboard << 17);
+    if ((bitboard << 15) & not_h_file) attacks |= (bitboard << 15);
+    if ((bitboard << 10) & not_ab_file) attacks |= (bitboard << 10);
+    if ((bitboard << 6) & not_hg_file) attacks |= (bitboard << 6);
+
+    return attacks;
+}
+
+// generate king attacks
+constexpr Bitboard mask_king_attacks(int sq) {
+    Bitboard attacks = 0ULL;
+    Bitboard bitboard = 1ULL << sq;
+
+    if (bitboard >> 8) attacks |= (bitboard >> 8);
+    if ((bitboard >> 9) & not_h_file) attacks |= (bitboard >> 9);
+    if ((bitboard >> 7) & not_a_file) attacks |= (bitboard >> 7);
+    if ((bitboard >> 1) & not_h_file) attacks |= (bitboard >> 1);
+    if (bitboard << 8) attacks |= (bitboard << 8);
+    if ((bitboard << 9) & not_a_file) attacks |= (bitboard << 9);
+    if ((bitboard << 7) & not_h_file) attacks |= (bitboard << 7);
+    if ((bitboard << 1) & not_a_file) attacks |= (bitboard << 1);
+
+    return attacks;
+}
+
+// mask relevant bishop occupancy bits
+constexpr Bitboard mask_bishop_attacks(int sq) {
+    Bitboard attacks = 0ULL;
+
+    int r, f;
+    int tr = sq / 8;
+    int tf = sq % 8;
+
+    for (r = tr + 1, f = tf + 1; r <= 6 && f <= 6; r++, f++) attacks |= (1ULL << (r * 8 + f));
+    for (r = tr - 1, f = tf + 1; r >= 1 && f <= 6; r--, f++) attacks |= (1ULL << (r * 8 + f));
+    for (r = tr + 1, f = tf - 1; r <= 6 && f >= 1; r++, f--) attacks |= (1ULL << (r * 8 + f));
+    for (r = tr - 1, f = tf - 1; r >= 1 && f >= 1; r--, f--) attacks |= (1ULL << (r * 8 + f));
+
+    return attacks;
+}
+
+// mask relevant rook occupancy bits
+constexpr Bitboard mask_rook_attacks(int sq) {
+    Bitboard attacks = 0ULL;
+
+    int r, f;
+    int tr = sq / 8;
+    int tf = sq % 8;
+
+    for (r = tr + 1; r <= 6; r++) attacks |= (1ULL << (r * 8 + tf));
+    for (r = tr - 1; r >= 1; r--) attacks |= (1ULL << (r * 8 + tf));
+    for (f = tf + 1; f <= 6; f++) attacks |= (1ULL << (tr * 8 + f));
+    for (f = tf - 1; f >= 1; f--) attacks |= (1ULL << (tr * 8 + f));
+
+    return attacks;
+}
+
+// Build a [square] table from a per-square generator
+template <typename Generator>
+constexpr std::array<Bitboard, 64> make_square_table(Generator generate) {
+    std::array<Bitboard, 64> table = {};
+    for (int sq = 0; sq < 64; ++sq) table[sq] = generate(sq);
+    return table;
+}
+
+// Attack tables
+inline constexpr std::array<std::array<Bitboard, 64>, 2> pawn_attacks = {  // [side][square]
+    make_square_table([](int sq) { return mask_pawn_attacks(WHITE, sq); }),
+    make_square_table([](int sq) { return mask_pawn_attacks(BLACK, sq); })};
+inline constexpr std::array<Bitboard, 64> knight_attacks = make_square_table(mask_knight_attacks);
+inline constexpr std::array<Bitboard, 64> king_attacks = make_square_table(mask_king_attacks);
+inline constexpr std::array<Bitboard, 64> bishop_masks = make_square_table(mask_bishop_attacks);
+inline constexpr std::array<Bitboard, 64> rook_masks = make_square_table(mask_rook_attacks);
+
+// Slider tables are too large to build in every translation unit; attackgen.cpp owns them
+#ifdef SHARED_SLIDER_TABLE
+constexpr int BISHOP_TABLE_SIZE = 5248;  // Sum of 2^bishop_relevant_bits over all squares
+constexpr int ROOK_TABLE_SIZE = 102400;  // Sum of 2^rook_relevant_bits over all squares
+
+// Start of each square's slice, laid out back to back from `start`
+constexpr std::array<int, 64> make_slice_offsets(const int* relevant_bits, int start) {
+    std::array<int, 64> offsets = {};
+    for (int sq = 0; sq < 64; ++sq) {
+        offsets[sq] = start;
+        start += 1 << relevant_bits[sq];
+    }
+    return offsets;
+}
+
+inline constexpr std::array<int, 64> bishop_offsets = make_slice_offsets(bishop_relevant_bits, 0);
+inline constexpr std::array<int, 64> rook_offsets =
+    make_slice_offsets(rook_relevant_bits, BISHOP_TABLE_SIZE);
+static_assert(rook_offsets[63] + (1 << rook_relevant_bits[63]) ==
+              BISHOP_TABLE_SIZE + ROOK_TABLE_SIZE);
+
+extern const std::array<Bitboard, BISHOP_TABLE_SIZE + ROOK_TABLE_SIZE>
+    slider_attacks;  // bishops, then rooks
+#else
+extern const std::array<std::array<Bitboard, 512>, 64> bishop_attacks;  // [square][occupancies]
+extern const std::array<std::array<Bitboard, 4096>, 64> rook_attacks;   // [square][occupancies]
+#endif
+
+/*
+    Slider attack lookups
+*/
+
+// Index of an occupancy within a square's slice of the attack table
+static inline uint64_t bishop_index(int sq, Bitboard occupancy) {
+#ifdef USE_PEXT
+    return _pext_u64(occupancy, bishop_masks[sq]);
+#else
+    occupancy &= bishop_masks[sq];
+    occupancy *= bishop_magic_numbers[sq];
+    return occupancy >> (64 - bishop_relevant_bits[sq]);
+#endif
+}
+
+static inline uint64_t rook_index(int sq, Bitboard occupancy) {
+#ifdef USE_PEXT
+    return _pext_u64(occupancy, rook_masks[sq]);
+#else
+    occupancy &= rook_masks[sq];
+    occupancy *= rook_magic_numbers[sq];
+    return occupancy >> (64 - rook_relevant_bits[sq]);
+#endif
+}
+
+// get bishop attacks
+static inline Bitboard get_bishop_attacks(int sq, Bitboard occupancy) {
+#ifdef SHARED_SLIDER_TABLE
+    return slider_attacks[bishop_offsets[sq] + bishop_index(sq, occupancy)];
+#else
+    return bishop_attacks[sq][bishop_index(sq, occupancy)];
+#endif
+}
+
+// get rook attacks
+static inline Bitboard get_rook_attacks(int sq, Bitboard occupancy) {
+#ifdef SHARED_SLIDER_TABLE
+    return slider_attacks[rook_offsets[sq] + rook_index(sq, occupancy)];
+#else
+    return rook_attacks[sq][rook_index(sq, occupancy)];
+#endif
+}
+
+// get queen attacks
+static inline Bitboard get_queen_attacks(int sq, Bitboard occupancy) {
+    return get_bishop_attacks(sq, occupancy) | get_rook_attacks(sq, occupancy);
+}
+
 #endif  // ATTACKGEN_HPP
\ No newline at end of file
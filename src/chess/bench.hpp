@@ -3,13 +3,20 @@
 #ifndef BENCH_HPP
 #define BENCH_HPP
 
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "../UciHandler.hpp"
+#include "../perfcounters.hpp"
 #include "../search.hpp"
 #include "../timeman.hpp"
 #include "../ttable.hpp"
 #include "Board.hpp"
+#include "moveio.hpp"
 
 // 50 bench positions from Heimdall
 std::string bench_positions[] = {
@@ -65,33 +72,199 @@ std::string bench_positions[] = {
     "2r2b2/5p2/5k2/p1r1pP2/P2pB3/1P3P2/K1P3R1/7R w - - 23 93"};
 
 constexpr uint8_t BENCH_DEPTH = 8;
+constexpr uint32_t BENCH_HASH = 16;
+
+enum BenchFormat { BENCH_TEXT, BENCH_JSON, BENCH_CSV };
+
+// bench [depth] [hash] [threads] [file] [json|csv] [perf]
+typedef struct {
+    uint8_t depth = BENCH_DEPTH;
+    uint32_t hash_size = BENCH_HASH;
+    uint16_t threads = 1;
+    std::string file;  // One FEN per line (anything after ';' is ignored); built-in suite if empty
+    BenchFormat format = BENCH_TEXT;
+    bool perf = false;  // Count hardware events around each search (Linux only)
+} BenchConfig;
+
+// Reads the FENs of a positions file, skipping blank and '#' lines
+static inline std::vector<std::string> load_bench_positions(const std::string& path) {
+    std::vector<std::string> positions;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find(';'));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty() && line[0] != '#') {
+            positions.push_back(line);
+        }
+    }
+    return positions;
+}
+
+// Per-node hardware counts; a counter that could not be opened is reported as n/a (JSON null)
+static inline void print_perf_counters(const PerfCounters& counters, uint64_t nodes,
+                                       const BenchConfig& config) {
+    bool cycles_ok = counters.fds[PERF_CYCLES] >= 0;
+    bool ipc_ok = cycles_ok && counters.fds[PERF_INSTRUCTIONS] >= 0;
+    double ipc = ipc_ok ? (double)counters.values[PERF_INSTRUCTIONS] /
+                              std::max(counters.values[PERF_CYCLES], (uint64_t)1)
+                        : 0.0;
+    nodes = std::max(nodes, (uint64_t)1);
+
+    if (config.format == BENCH_JSON) {
+        std::cout << "{\"perf_per_node\": {";
+        for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+            std::cout << (i ? ", " : "") << "\"" << perf_counter_names[i] << "\": ";
+            if (counters.fds[i] >= 0) {
+                std::cout << (double)counters.values[i] / nodes;
+            } else {
+                std::cout << "null";
+            }
+        }
+        std::cout << "}, \"ipc\": ";
+        if (ipc_ok) {
+            std::cout << ipc;
+        } else {
+            std::cout << "null";
+        }
+        std::cout << ", \"perf_error\": \"" << counters.error << "\"}\n";
+    } else if (config.format == BENCH_CSV) {
+        // Raw totals; divide by the total row's nodes for per-node figures
+        for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+            if (counters.fds[i] >= 0) {
+                std::cout << "perf_" << perf_counter_names[i] << ",," << (int)config.depth << ","
+                          << counters.values[i] << ",,,\n";
+            }
+        }
+    } else {
+        std::cout << "\nHardware counters per node";
+        if (!counters.error.empty()) {
+            std::cout << " (some unavailable: " << counters.error << ")";
+        }
+        std::cout << ":\n";
+        for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+            std::cout << "  " << std::left << std::setw(14) << perf_counter_names[i] << std::right;
+            if (counters.fds[i] >= 0) {
+                std::cout << std::fixed << std::setprecision(2)
+                          << (double)counters.values[i] / nodes << "\n";
+            } else {
+                std::cout << "n/a\n";
+            }
+        }
+        std::cout << "  " << std::left << std::setw(14) << "IPC" << std::right;
+        if (ipc_ok) {
+            std::cout << ipc << "\n";
+        } else {
+            std::cout << "n/a\n";
+        }
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+}
+
+// Searches every position to a fixed depth. The node count over the suite is deterministic and
+// serves as the signature of the search: the last line of the JSON and CSV output, and the first
+// field of the text output's last line (the "<nodes> nodes <nps> nps" format OpenBench parses).
+static inline bool run_bench(Board& pos, HashTable& table, SearchInfo& info, UciHandler uci,
+                             const BenchConfig& config) {
+    std::vector<std::string> positions(std::begin(bench_positions), std::end(bench_positions));
+    if (!config.file.empty()) {
+        positions = load_bench_positions(config.file);
+        if (positions.empty()) {
+            std::cerr << "No bench positions found in " << config.file << "\n";
+            return false;
+        }
+    }
 
-static inline void run_bench(Board& pos, HashTable& table, SearchInfo& info, UciHandler uci) {
     UciOptions options;
-    options.hash_size = 16;
-    options.threads = 1;
+    options.hash_size = std::clamp(config.hash_size, (uint32_t)MIN_HASH, MAX_HASH);
+    options.threads = 1;  // The search is single-threaded
     options.move_overhead = 75;
-    init_hash_table(table, 16);
+    options.ponder = false;
+    options.multipv = 1;
+    init_hash_table(table, options.hash_size);
+    info.print_info = config.format == BENCH_TEXT;
+
+    if (config.format == BENCH_CSV) {
+        std::cout << "position,fen,depth,nodes,time_ms,nps,bestmove\n";
+    }
+
+    PerfCounters counters;
+    bool counting = config.perf && open_perf_counters(counters);
+    if (config.perf && !counting) {
+        std::cerr << "Hardware counters unavailable: " << counters.error << "\n";
+    }
 
     uint64_t total_nodes = 0;
+    SearchStats total_stats;
+    clear_search_stats(total_stats);
     uint64_t start = get_time_ms();
 
-    for (int index = 0; index < 50; ++index) {
-        std::cout << "\n=== Benching position " << index + 1 << "/50 ===\n";
+    for (int index = 0; index < (int)positions.size(); ++index) {
+        if (config.format == BENCH_TEXT) {
+            std::cout << "\n=== Benching position " << index + 1 << "/" << positions.size()
+                      << " ===\n";
+            std::cout << "Position: " << positions[index] << "\n";
+        }
         info.nodes = 0;
-        std::cout << "Position: " << bench_positions[index] << "\n";
-        parse_fen(pos, bench_positions[index]);
-        std::string command = "go depth " + std::to_string(BENCH_DEPTH);
+        parse_fen(pos, positions[index]);
+        reset_undo_stack(info.undo);
+        std::string command = "go depth " + std::to_string(config.depth);
+        uint64_t position_start = get_time_ms();
+        if (counting) {
+            start_perf_counters(counters);
+        }
         uci.parse_go(pos, table, info, &options, command);
+        if (counting) {
+            stop_perf_counters(counters);
+        }
         total_nodes += info.nodes;
+        add_search_stats(total_stats, info.stats);
+
+        uint64_t time = get_time_ms() - position_start;
+        uint64_t nps = info.nodes * 1000 / std::max(time, (uint64_t)1);
+        std::string best_move = print_move(info.PV_array.moves[0]);
+        if (config.format == BENCH_JSON) {
+            std::cout << "{\"position\": " << index + 1 << ", \"fen\": \"" << positions[index]
+                      << "\", \"depth\": " << (int)config.depth << ", \"nodes\": " << info.nodes
+                      << ", \"time_ms\": " << time << ", \"nps\": " << nps
+                      << ", \"bestmove\": \"" << best_move << "\"}\n";
+        } else if (config.format == BENCH_CSV) {
+            std::cout << index + 1 << ",\"" << positions[index] << "\"," << (int)config.depth << ","
+                      << info.nodes << "," << time << "," << nps << "," << best_move << "\n";
+        }
     }
+    info.print_info = true;
 
     uint64_t end = get_time_ms();
     uint64_t time = end - start;
-    std::cout << "\n-#-#- Benchmark results -#-#-\n";
-    std::cout << "Execution time: " << time / 1000.0 << "s \n";
-    std::cout << total_nodes << " nodes " << int(total_nodes / (double)time * 1000) << " nps\n"
-              << std::flush;
+    uint64_t nps = total_nodes * 1000 / std::max(time, (uint64_t)1);
+    if (counting) {
+        print_perf_counters(counters, total_nodes, config);
+        close_perf_counters(counters);
+    }
+#ifdef SEARCH_STATS
+    if (config.format == BENCH_JSON) {
+        std::cout << "{\"stats\": " << search_stats_json(total_stats) << "}\n";
+    }
+#endif
+    if (config.format == BENCH_JSON) {
+        // JSON Lines: one object per position, then the totals and the signature
+        std::cout << "{\"total_nodes\": " << total_nodes << ", \"time_ms\": " << time
+                  << ", \"nps\": " << nps << ", \"hash\": " << options.hash_size
+                  << ", \"threads\": " << options.threads << "}\n"
+                  << "{\"signature\": " << total_nodes << "}\n";
+    } else if (config.format == BENCH_CSV) {
+        std::cout << "total,," << (int)config.depth << "," << total_nodes << "," << time << ","
+                  << nps << ",\n"
+                  << "signature,," << (int)config.depth << "," << total_nodes << ",,,\n";
+    } else {
+        std::cout << "\n-#-#- Benchmark results -#-#-\n";
+        std::cout << "Execution time: " << time / 1000.0 << "s \n";
+        std::cout << total_nodes << " nodes " << nps << " nps\n";
+    }
+    std::cout << std::flush;
+
+    return true;
 }
 
-#endif  // BENCH_HPP
\ No newline at end of file
+#endif  // BENCH_HPP
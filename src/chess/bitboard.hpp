@@ -19,10 +19,10 @@
 #define SAME_DIAGONAL(sq1, sq2) \
     ((diagonals[(sq1)] == diagonals[(sq2)]) || (anti_diagonals[(sq1)] == anti_diagonals[(sq2)]))
 
-const Bitboard LIGHT_SQUARES =
-    0xAA55AA55AA55AA55ULL;                           // Bits corresponding to light squares are set
-const Bitboard BOTTOM_HALF = 0x00000000FFFFFFFFULL;  // A1 ~ H4 set
-const Bitboard TOP_HALF = 0xFFFFFFFF00000000ULL;     // A5 ~ H8 set
+constexpr Bitboard LIGHT_SQUARES =
+    0xAA55AA55AA55AA55ULL;  // Bits corresponding to light squares are set
+constexpr Bitboard BOTTOM_HALF = 0x00000000FFFFFFFFULL;  // A1 ~ H4 set
+constexpr Bitboard TOP_HALF = 0xFFFFFFFF00000000ULL;     // A5 ~ H8 set
 
 extern const int diagonals[64];
 extern const int anti_diagonals[64];
@@ -41,48 +41,86 @@ static inline uint8_t pop_ls1b(Bitboard &bb) {
 // Counts the number of set bits in a bitboard
 static inline uint8_t count_bits(Bitboard bb) { return (uint8_t)std::popcount(bb); }
 
-// Bitboard functions
-// Mask a bitboard with bits between 2 given squares set
-static inline Bitboard bits_between_squares(uint8_t sq1, uint8_t sq2) {
-    Bitboard mask = 0ULL;
-    uint8_t rank1 = GET_RANK(sq1);
-    uint8_t rank2 = GET_RANK(sq2);
-    uint8_t file1 = GET_FILE(sq1);
-    uint8_t file2 = GET_FILE(sq2);
-
-    bool same_rank = rank1 == rank2;
-    bool same_file = file1 == file2;
-
-    // 0-D case
-    if (sq1 == sq2) {
-        return mask;
-    }
-    // 1-D cases
-    else if (same_rank ^ same_file) {
-        if (same_rank) {
-            for (int sq = std::min(sq1, sq2); sq <= std::max(sq1, sq2); ++sq) {
-                SET_BIT(mask, sq);
+/*
+    Square relation tables, generated at compile time
+*/
+
+typedef std::array<std::array<Bitboard, 64>, 64> SquarePairTable;  // [sq1][sq2]
+
+// For every pair of squares sharing a rank, file or diagonal: the bits strictly between them,
+// or with `full_line` the whole line through both (edge to edge, both included). Else 0.
+constexpr SquarePairTable make_square_pair_table(bool full_line) {
+    constexpr int directions[8][2] = {{1, 0}, {-1, 0}, {0, 1},  {0, -1},
+                                      {1, 1}, {-1, -1}, {1, -1}, {-1, 1}};  // {file, rank}
+    SquarePairTable table = {};
+
+    for (int sq1 = 0; sq1 < 64; ++sq1) {
+        for (int dir = 0; dir < 8; ++dir) {
+            int df = directions[dir][0];
+            int dr = directions[dir][1];
+
+            // Both rays from sq1 along this axis, plus sq1 itself
+            Bitboard line = 1ULL << sq1;
+            for (int sign = -1; sign <= 1; sign += 2) {
+                int file = GET_FILE(sq1) + sign * df;
+                int rank = GET_RANK(sq1) + sign * dr;
+                for (; file >= 0 && file < 8 && rank >= 0 && rank < 8;
+                     file += sign * df, rank += sign * dr) {
+                    line |= 1ULL << FR2SQ(file, rank);
+                }
             }
-        } else {
-            for (int sq = std::min(sq1, sq2); sq <= std::max(sq1, sq2); sq += 8) {
-                SET_BIT(mask, sq);
+
+            Bitboard between = 0ULL;
+            int file = GET_FILE(sq1) + df;
+            int rank = GET_RANK(sq1) + dr;
+            for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += df, rank += dr) {
+                int sq2 = FR2SQ(file, rank);
+                table[sq1][sq2] = full_line ? line : between;
+                between |= 1ULL << sq2;
             }
         }
     }
-    // 2-D case
-    else {
-        for (int rank = std::min(rank1, rank2); rank <= std::max(rank1, rank2); ++rank) {
-            for (int file = std::min(file1, file2); file <= std::max(file1, file2); ++file) {
-                uint8_t sq = FR2SQ(file, rank);
-                SET_BIT(mask, sq);
+    return table;
+}
+
+inline constexpr SquarePairTable between_masks = make_square_pair_table(false);
+inline constexpr SquarePairTable line_masks = make_square_pair_table(true);
+
+// Pawn shield zone in front of a castled king, empty once the king leaves its own half [col][sq]
+/*
+    --------
+    --------
+    --------
+    --------
+    -----xxx
+    -----xxx
+    -----xxx
+    ------K-
+*/
+constexpr std::array<std::array<Bitboard, 64>, 2> make_shield_zones() {
+    std::array<std::array<Bitboard, 64>, 2> zones = {};
+    for (int king_sq = 0; king_sq < 64; ++king_sq) {
+        int king_file = GET_FILE(king_sq);
+        int king_rank = GET_RANK(king_sq);
+
+        for (int file = king_file - 1; file <= king_file + 1; ++file) {
+            if (file < FILE_A || file > FILE_H) continue;
+            // King shield is useless when you're on the other side of the board
+            for (int dist = 1; dist <= 3; ++dist) {
+                if (king_rank > RANK_5) {
+                    zones[WHITE][king_sq] |= 1ULL << FR2SQ(file, king_rank - dist);
+                }
+                if (king_rank < RANK_4) {
+                    zones[BLACK][king_sq] |= 1ULL << FR2SQ(file, king_rank + dist);
+                }
             }
         }
     }
-
-    return mask;
+    return zones;
 }
 
-Bitboard generate_shield_zone(uint8_t king_sq, uint8_t col);
+inline constexpr std::array<std::array<Bitboard, 64>, 2> shield_zones = make_shield_zones();
+
 void print_bitboard(Bitboard board);
 [[nodiscard]] constexpr uint8_t dist_between_squares(uint8_t sq1, uint8_t sq2);
 
@@ -74,12 +74,19 @@ static void move_piece(Board &pos, const int from, const int to) {
         Move manipulation
 */
 
-void take_move(Board &pos) {
+#ifdef COPY_MAKE
+
+// Copy-make: the position saved by make_move is simply copied back
+void take_move(Board &pos, const UndoStack &undo) { pos = undo.move_history[pos.his_ply - 1].pos; }
+
+#else
+
+void take_move(Board &pos, const UndoStack &undo) {
     pos.ply--;
     pos.his_ply--;
 
-    UndoBox box = pos.move_history[pos.his_ply];
-    int move = box.move;
+    UndoBox box = undo.move_history[pos.his_ply];
+    Move move = box.move;
     int from = get_move_source(move);
     int to = get_move_target(move);
 
@@ -92,6 +99,8 @@ void take_move(Board &pos) {
     pos.castle_perms = box.castle_perms;
     pos.fifty_move = box.fifty_move;
     pos.enpas = box.enpas;
+    pos.checkers = box.checkers;
+    pos.pinned = box.pinned;
 
     // Rehash
     if (pos.enpas != NO_SQ) {
@@ -134,27 +143,83 @@ void take_move(Board &pos) {
     }
 
     // Undo captures
-    int captured = get_move_captured(move);
-    if (captured != EMPTY && !get_move_enpassant(move)) {
-        add_piece(pos, to, captured);
+    if (box.captured != EMPTY && !get_move_enpassant(move)) {
+        add_piece(pos, to, box.captured);
     }
 
     // Undo promotion
-    if (get_move_promoted(move) != EMPTY) {
+    if (get_move_promoted(move) != NONE) {
         clear_piece(pos, from);
-        add_piece(pos, from, (piece_col[get_move_promoted(move)] == WHITE) ? wP : bP);
+        add_piece(pos, from, (pos.side == WHITE) ? wP : bP);
+    }
+}
+
+#endif  // COPY_MAKE
+
+// Checks if a pseudo-legal move keeps our king safe, without making it
+// Needs pos.checkers and pos.pinned to be up to date
+bool is_legal_move(const Board &pos, Move move) {
+    int from = get_move_source(move);
+    int to = get_move_target(move);
+    int king_sq = pos.king_sq[pos.side];
+    Bitboard from_to = (1ULL << from) | (1ULL << to);
+
+    // En passant empties two squares on a line through the king; look at the result directly
+    if (get_move_enpassant(move)) {
+        Bitboard captured = 1ULL << ((pos.side == WHITE) ? to + 8 : to - 8);
+        Bitboard occupancy = (pos.occupancies[BOTH] ^ from_to) ^ captured;
+        return !is_square_attacked_after(pos, king_sq, occupancy, captured);
     }
+
+    // The king may not step onto an attacked square (or stay on a checking slider's line).
+    // Castling squares the king starts on and crosses were checked by movegen
+    if (from == king_sq) {
+        Bitboard occupancy = (pos.occupancies[BOTH] & ~(1ULL << from)) | (1ULL << to);
+        return !is_square_attacked_after(pos, to, occupancy, 1ULL << to);
+    }
+
+    // Other pieces must capture or block a single checker...
+    if (pos.checkers) {
+        if (count_bits(pos.checkers) > 1) {
+            return false;
+        }
+        uint8_t checker_sq = __builtin_ctzll(pos.checkers);
+        if (!GET_BIT(between_masks[king_sq][checker_sq] | pos.checkers, to)) {
+            return false;
+        }
+    }
+
+    // ...and may only leave a pin along its line
+    return !GET_BIT(pos.pinned, from) || GET_BIT(line_masks[king_sq][from], to);
 }
 
 // Makes a move on the board
-// Returns true if legal, and false if illegal
-bool make_move(Board &pos, int move) {
+// Returns true if legal, and false if illegal (the board is then left untouched)
+bool make_move(Board &pos, UndoStack &undo, Move move) {
+    if (!is_legal_move(pos, move)) {
+        return false;
+    }
+
     int from = get_move_source(move);
     int to = get_move_target(move);
     int side = pos.side;
 
-    UndoBox box = {0, 0, 0, 0, 0};
-    box.hash_key = pos.hash_key;
+    int captured = get_move_captured(pos, move);
+
+    // Save what take_move needs to restore the position
+    UndoBox &box = undo.move_history[pos.his_ply];
+    box.move = move;
+#ifdef COPY_MAKE
+    box.pos = pos;
+#else
+    box.captured = captured;
+    box.castle_perms = pos.castle_perms;
+    box.enpas = pos.enpas;
+    box.fifty_move = pos.fifty_move;
+    box.checkers = pos.checkers;
+    box.pinned = pos.pinned;
+#endif
+    undo.key_history[pos.his_ply] = pos.hash_key;
 
     if (get_move_enpassant(move)) {
         // Clear the captured pawn
@@ -186,12 +251,6 @@ bool make_move(Board &pos, int move) {
     }
     HASH_CA(pos);
 
-    box.move = move;
-    box.fifty_move = pos.fifty_move;
-    box.enpas = pos.enpas;
-    box.castle_perms = pos.castle_perms;
-    pos.move_history[pos.his_ply] = box;
-
     pos.castle_perms &= castling_rights[from];
     pos.castle_perms &= castling_rights[to];
     pos.enpas = NO_SQ;
@@ -200,7 +259,6 @@ bool make_move(Board &pos, int move) {
     pos.fifty_move++;
 
     // Handle other captures
-    int captured = get_move_captured(move);
     // We exclude en passant here since it was handled earlier
     if (captured && !get_move_enpassant(move)) {
         clear_piece(pos, to);
@@ -242,10 +300,10 @@ bool make_move(Board &pos, int move) {
 
     // Handle promotions
     int prPce = get_move_promoted(move);
-    if (prPce != EMPTY) {
+    if (prPce != NONE) {
         // Replace the pawn with the promoted piece
         clear_piece(pos, to);
-        add_piece(pos, to, prPce);
+        add_piece(pos, to, (side == WHITE) ? prPce : prPce + 6);
     }
 
     // Detect king move
@@ -257,14 +315,7 @@ bool make_move(Board &pos, int move) {
     pos.side ^= 1;
     HASH_SIDE(pos);
 
-    // It is an illegal move if we reveal a check to our king
-    // side: Our side (the mover)
-    // pos.get_side(): Opponent's side (switched after making the move)
-    if (is_square_attacked(pos, pos.king_sq[side], pos.side)) {
-        take_move(pos);
-        return false;  // Illegal move
-    }
-
+    update_check_info(pos);
     return true;
 }
 
@@ -272,27 +323,38 @@ bool make_move(Board &pos, int move) {
         Null move manipulation
 */
 
-void make_null_move(Board &pos) {
-    pos.ply++;
-    UndoBox &box = pos.move_history[pos.his_ply];
-    box.hash_key = pos.hash_key;
+void make_null_move(Board &pos, UndoStack &undo) {
+    UndoBox &box = undo.move_history[pos.his_ply];
+    box.move = NO_MOVE;
+#ifdef COPY_MAKE
+    box.pos = pos;
+#else
+    box.captured = EMPTY;
+    box.castle_perms = pos.castle_perms;
+    box.enpas = pos.enpas;
+    box.fifty_move = pos.fifty_move;
+    box.checkers = pos.checkers;
+    box.pinned = pos.pinned;
+#endif
+    undo.key_history[pos.his_ply] = pos.hash_key;
 
     if (pos.enpas != NO_SQ) {
         HASH_EP(pos);
     }
 
-    box.move = NO_MOVE;
-    box.fifty_move = pos.fifty_move;
-    box.enpas = pos.enpas;
-    box.castle_perms = pos.castle_perms;
-
+    pos.ply++;
     pos.his_ply++;
     pos.enpas = NO_SQ;
     pos.side ^= 1;
     HASH_SIDE(pos);
+
+    update_check_info(pos);  // The other side now has its own pins
 }
 
-void take_null_move(Board &pos) {
+void take_null_move(Board &pos, const UndoStack &undo) {
+#ifdef COPY_MAKE
+    pos = undo.move_history[pos.his_ply - 1].pos;
+#else
     pos.ply--;
     pos.his_ply--;
 
@@ -300,14 +362,17 @@ void take_null_move(Board &pos) {
         HASH_EP(pos);
     }
 
-    UndoBox box = pos.move_history[pos.his_ply];
+    UndoBox box = undo.move_history[pos.his_ply];
     pos.castle_perms = box.castle_perms;
     pos.fifty_move = box.fifty_move;
     pos.enpas = box.enpas;
+    pos.checkers = box.checkers;
+    pos.pinned = box.pinned;
 
     if (pos.enpas != NO_SQ) {
         HASH_EP(pos);
     }
     pos.side ^= 1;
     HASH_SIDE(pos);
+#endif
 }
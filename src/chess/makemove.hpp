@@ -12,10 +12,11 @@
 constexpr uint8_t NO_MOVE = 0;
 
 // Functions
-void take_move(Board& pos);
-bool make_move(Board& pos, int move);
-void make_null_move(Board& pos);
-void take_null_move(Board& pos);
+bool is_legal_move(const Board& pos, Move move);
+void take_move(Board& pos, const UndoStack& undo);
+bool make_move(Board& pos, UndoStack& undo, Move move);
+void make_null_move(Board& pos, UndoStack& undo);
+void take_null_move(Board& pos, const UndoStack& undo);
 
 /*
                            castling   move     in      in
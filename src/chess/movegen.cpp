@@ -60,8 +60,8 @@ static int mvv_lva[12][12] = {{105, 205, 305, 405, 505, 605, 105, 205, 305, 405,
 */
 
 // add move to the move list
-static inline void add_move(MoveList &move_list, int move, int score) {
-    Move move_struct = {move, score};
+static inline void add_move(MoveList &move_list, Move move, int score) {
+    ScoredMove move_struct = {move, score};
     move_list.moves[move_list.length] = move_struct;
     move_list.length++;
 }
@@ -86,22 +86,25 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                 if (!GET_BIT(pos.occupancies[BOTH], target_square)) {
                     // pawn promotion
                     if (GET_RANK(source_square) == RANK_7) {
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(QUEEN, false)),
+                            5'000'000);
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, wQ, 0, 0, 0, 0),
-                                 5'000'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, wR, 0, 0, 0, 0),
+                                 encode_move(source_square, target_square, promo_flag(ROOK, false)),
                                  200'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, wB, 0, 0, 0, 0),
-                                 100'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, wN, 0, 0, 0, 0),
-                                 300'000);
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(BISHOP, false)),
+                            100'000);
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(KNIGHT, false)),
+                            300'000);
                     } else {
                         // one square ahead pawn move
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0),
+                                 encode_move(source_square, target_square, QUIET_FLAG),
                                  0);
 
                         // two squares ahead pawn move
@@ -109,7 +112,7 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                             !GET_BIT(pos.occupancies[BOTH], target_square - 8)) {
                             add_move(
                                 move_list,
-                                encode_move(source_square, target_square - 8, piece, 0, 0, 1, 0, 0),
+                                encode_move(source_square, target_square - 8, DOUBLE_FLAG),
                                 0);
                         }
                     }
@@ -127,22 +130,25 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                 if (!GET_BIT(pos.occupancies[BOTH], target_square)) {
                     // pawn promotion
                     if (GET_RANK(source_square) == RANK_2) {
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(QUEEN, false)),
+                            5'000'000);
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, bQ, 0, 0, 0, 0),
-                                 5'000'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, bR, 0, 0, 0, 0),
+                                 encode_move(source_square, target_square, promo_flag(ROOK, false)),
                                  200'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, bB, 0, 0, 0, 0),
-                                 100'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, bN, 0, 0, 0, 0),
-                                 300'000);
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(BISHOP, false)),
+                            100'000);
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(KNIGHT, false)),
+                            300'000);
                     } else {
                         // one square ahead pawn move
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0),
+                                 encode_move(source_square, target_square, QUIET_FLAG),
                                  0);
 
                         // two squares ahead pawn move
@@ -150,7 +156,7 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                             !GET_BIT(pos.occupancies[BOTH], target_square + 8)) {
                             add_move(
                                 move_list,
-                                encode_move(source_square, target_square + 8, piece, 0, 0, 1, 0, 0),
+                                encode_move(source_square, target_square + 8, DOUBLE_FLAG),
                                 0);
                         }
                     }
@@ -165,9 +171,8 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                 // King side castling
                 if (pos.castle_perms & WKCA) {
                     if (pos.pieces[f1] == EMPTY && pos.pieces[g1] == EMPTY) {
-                        if (!is_square_attacked(pos, e1, BLACK) &&
-                            !is_square_attacked(pos, f1, BLACK)) {
-                            add_move(move_list, encode_move(e1, g1, piece, 0, 0, 0, 0, 1), 750'000);
+                        if (!pos.checkers && !is_square_attacked(pos, f1, BLACK)) {
+                            add_move(move_list, encode_move(e1, g1, KCASTLE_FLAG), 750'000);
                         }
                     }
                 }
@@ -175,9 +180,8 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                 if (pos.castle_perms & WQCA) {
                     if (pos.pieces[d1] == EMPTY && pos.pieces[c1] == EMPTY &&
                         pos.pieces[b1] == EMPTY) {
-                        if (!is_square_attacked(pos, e1, BLACK) &&
-                            !is_square_attacked(pos, d1, BLACK)) {
-                            add_move(move_list, encode_move(e1, c1, piece, 0, 0, 0, 0, 1), 750'000);
+                        if (!pos.checkers && !is_square_attacked(pos, d1, BLACK)) {
+                            add_move(move_list, encode_move(e1, c1, QCASTLE_FLAG), 750'000);
                         }
                     }
                 }
@@ -187,9 +191,8 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                 // King side castling
                 if (pos.castle_perms & BKCA) {
                     if (pos.pieces[f8] == EMPTY && pos.pieces[g8] == EMPTY) {
-                        if (!is_square_attacked(pos, e8, WHITE) &&
-                            !is_square_attacked(pos, f8, WHITE)) {
-                            add_move(move_list, encode_move(e8, g8, piece, 0, 0, 0, 0, 1), 750'000);
+                        if (!pos.checkers && !is_square_attacked(pos, f8, WHITE)) {
+                            add_move(move_list, encode_move(e8, g8, KCASTLE_FLAG), 750'000);
                         }
                     }
                 }
@@ -197,9 +200,8 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                 if (pos.castle_perms & BQCA) {
                     if (pos.pieces[d8] == EMPTY && pos.pieces[c8] == EMPTY &&
                         pos.pieces[b8] == EMPTY) {
-                        if (!is_square_attacked(pos, e8, WHITE) &&
-                            !is_square_attacked(pos, d8, WHITE)) {
-                            add_move(move_list, encode_move(e8, c8, piece, 0, 0, 0, 0, 1), 750'000);
+                        if (!pos.checkers && !is_square_attacked(pos, d8, WHITE)) {
+                            add_move(move_list, encode_move(e8, c8, QCASTLE_FLAG), 750'000);
                         }
                     }
                 }
@@ -214,7 +216,7 @@ static inline void generate_all_quiets(const Board &pos, MoveList &move_list) {
                     target_square = pop_ls1b(attacks);
                     if (pos.pieces[target_square] == EMPTY) {
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, 0, 0, 0, 0, 0),
+                                 encode_move(source_square, target_square, QUIET_FLAG),
                                  0);
                     }
                 }
@@ -243,31 +245,27 @@ static inline void generate_all_captures(const Board &pos, MoveList &move_list)
                 // generate pawn captures
                 while (attacks) {
                     target_square = pop_ls1b(attacks);
-                    int target_pce = pos.pieces[target_square];
 
                     // pawn promotion
                     if (GET_RANK(source_square) == RANK_7) {
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, wQ, target_pce, 0,
-                                             0, 0),
+                                 encode_move(source_square, target_square, promo_flag(QUEEN, true)),
                                  5'000'000);
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, wR, target_pce, 0,
-                                             0, 0),
+                                 encode_move(source_square, target_square, promo_flag(ROOK, true)),
                                  200'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, wB, target_pce, 0,
-                                             0, 0),
-                                 100'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, wN, target_pce, 0,
-                                             0, 0),
-                                 300'000);
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(BISHOP, true)),
+                            100'000);
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(KNIGHT, true)),
+                            300'000);
                     } else {
                         // Normal capture
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, 0, target_pce, 0,
-                                             0, 0),
+                                 encode_move(source_square, target_square, CAPTURE_FLAG),
                                  0);
                     }
                 }
@@ -281,7 +279,7 @@ static inline void generate_all_captures(const Board &pos, MoveList &move_list)
                         int target_enpassant = pop_ls1b(enpassant_attacks);
                         add_move(
                             move_list,
-                            encode_move(source_square, target_enpassant, piece, 0, bP, 0, 1, 0), 0);
+                            encode_move(source_square, target_enpassant, EP_FLAG), 0);
                     }
                 }
             }
@@ -297,31 +295,27 @@ static inline void generate_all_captures(const Board &pos, MoveList &move_list)
                 // generate pawn captures
                 while (attacks) {
                     target_square = pop_ls1b(attacks);
-                    int target_pce = pos.pieces[target_square];
 
                     // pawn promotion
                     if (GET_RANK(source_square) == RANK_2) {
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, bQ, target_pce, 0,
-                                             0, 0),
+                                 encode_move(source_square, target_square, promo_flag(QUEEN, true)),
                                  5'000'000);
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, bR, target_pce, 0,
-                                             0, 0),
+                                 encode_move(source_square, target_square, promo_flag(ROOK, true)),
                                  200'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, bB, target_pce, 0,
-                                             0, 0),
-                                 100'000);
-                        add_move(move_list,
-                                 encode_move(source_square, target_square, piece, bN, target_pce, 0,
-                                             0, 0),
-                                 300'000);
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(BISHOP, true)),
+                            100'000);
+                        add_move(
+                            move_list,
+                            encode_move(source_square, target_square, promo_flag(KNIGHT, true)),
+                            300'000);
                     } else {
                         // Normal capture
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, 0, target_pce, 0,
-                                             0, 0),
+                                 encode_move(source_square, target_square, CAPTURE_FLAG),
                                  0);
                     }
                 }
@@ -334,7 +328,7 @@ static inline void generate_all_captures(const Board &pos, MoveList &move_list)
                         int target_enpassant = pop_ls1b(enpassant_attacks);
                         add_move(
                             move_list,
-                            encode_move(source_square, target_enpassant, piece, 0, wP, 0, 1, 0), 0);
+                            encode_move(source_square, target_enpassant, EP_FLAG), 0);
                     }
                 }
             }
@@ -353,8 +347,7 @@ static inline void generate_all_captures(const Board &pos, MoveList &move_list)
 
                     if (piece_col[target_pce] == (side ^ 1)) {
                         add_move(move_list,
-                                 encode_move(source_square, target_square, piece, 0, target_pce, 0,
-                                             0, 0),
+                                 encode_move(source_square, target_square, CAPTURE_FLAG),
                                  0);
                     }
                 }
@@ -390,37 +383,39 @@ void generate_moves(const Board &pos, MoveList &move_list, bool noisy_only) {
 */
 
 // score moves
-static inline int score_move(const Board &pos, int move, int hash_move) {
+static inline int score_move(const Board &pos, const MoveHeuristics &heur, Move move,
+                             Move hash_move) {
     // Score hash move (PV move)
     if (hash_move != NO_MOVE && move == hash_move) {
         return 10'000'000;
     }
 
     // Score capture move
-    int captured = get_move_captured(move);
-    if (captured) {
-        return mvv_lva[get_move_piece(move) - 1][captured - 1] + 2'000'000;
+    if (get_move_capture(move)) {
+        int captured = get_move_captured(pos, move);
+        return mvv_lva[get_move_piece(pos, move) - 1][captured - 1] + 2'000'000;
     }
 
     // Score quiet move
-    if (pos.killer_moves[0][pos.ply] == move) return 950'000;  // Score 1st killer move
-    if (pos.killer_moves[1][pos.ply] == move) return 900'000;  // Score 2nd killer move
+    if (heur.killer_moves[0][pos.ply] == move) return 950'000;  // Score 1st killer move
+    if (heur.killer_moves[1][pos.ply] == move) return 900'000;  // Score 2nd killer move
 
-    int history_score = pos.history_moves[get_move_piece(move)][get_move_target(move)];
+    int history_score = heur.history_moves[get_move_piece(pos, move)][get_move_target(move)];
     return history_score;
 }
 
 // Sort moves in descending order
-void sort_moves(const Board &pos, MoveList &move_list, int hash_move) {
+void sort_moves(const Board &pos, const MoveHeuristics &heur, MoveList &move_list,
+                Move hash_move) {
     // Score all the moves
     for (int i = 0; i < (int)move_list.length; ++i) {
-        move_list.moves[i].score += score_move(pos, move_list.moves[i].move, hash_move);
+        move_list.moves[i].score += score_move(pos, heur, move_list.moves[i].move, hash_move);
     }
 
     // Insertion sort
     // std::stable_sort performance depends greatly on P/E cores
     for (int i = 1; i < (int)move_list.length; ++i) {
-        Move key = std::move(move_list.moves[i]);
+        ScoredMove key = std::move(move_list.moves[i]);
         int j = i - 1;
 
         // Shift elements > key.score to the right
@@ -433,15 +428,15 @@ void sort_moves(const Board &pos, MoveList &move_list, int hash_move) {
 }
 
 // Determine is a move is possible in a given position
-bool move_exists(Board &pos, const int move) {
+bool move_exists(Board &pos, UndoStack &undo, const Move move) {
     MoveList list;
     generate_moves(pos, list, false);
 
     for (int i = 0; i < (int)list.length; ++i) {
         if (list.moves[i].move == move) {
             // Verify it's legal
-            if (make_move(pos, move)) {
-                take_move(pos);
+            if (make_move(pos, undo, move)) {
+                take_move(pos, undo);
                 return true;
             }
         }
@@ -6,38 +6,79 @@
 #include "../StaticVector.hpp"
 #include "Board.hpp"
 
+// Quiet move ordering heuristics, owned by the search rather than the board
+typedef struct {
+    Move killer_moves[2][MAX_DEPTH];  // killer moves [id][ply]
+    int history_moves[13][64];        // history moves [piece][square]
+} MoveHeuristics;
+
 // Functions
 void generate_moves(const Board& pos, MoveList& move_list, bool noisy_only);
-void sort_moves(const Board& pos, MoveList& move_list, int hash_move);
-bool move_exists(Board& pos, const int move);
+void sort_moves(const Board& pos, const MoveHeuristics& heur, MoveList& move_list, Move hash_move);
+bool move_exists(Board& pos, UndoStack& undo, const Move move);
 
 /*
-          binary move bits                               hexidecimal constants
-
-    0000 0000 0000 0000 0000 0011 1111    source square       0x3f
-    0000 0000 0000 0000 1111 1100 0000    target square       0xfc0
-    0000 0000 0000 1111 0000 0000 0000    piece               0xf000
-    0000 0000 1111 0000 0000 0000 0000    promoted piece      0xf0000
-    0000 1111 0000 0000 0000 0000 0000    captured piece      0xf00000
-    0001 0000 0000 0000 0000 0000 0000    double push flag    0x1000000
-    0010 0000 0000 0000 0000 0000 0000    enpassant flag      0x2000000
-    0100 0000 0000 0000 0000 0000 0000    castling flag       0x4000000
+          binary move bits                 hexidecimal constants
+
+    0000 0000 0011 1111    source square       0x3f
+    0000 1111 1100 0000    target square       0xfc0
+    1111 0000 0000 0000    move flag           0xf000
+
+    The piece and captured piece are not stored in the move, they are read from pos.pieces
+    before the move is made. Moves are kept at 16 bits to keep move lists, the TT, killers and
+    PV lines small.
+
+           move flags
+
+    0000    quiet move
+    0001    double pawn push
+    0010    king-side castling
+    0011    queen-side castling
+    0100    capture
+    0101    en passant capture
+    10xx    promotion (xx: 00 knight, 01 bishop, 10 rook, 11 queen)
+    11xx    promotion with capture
 */
 
+enum {
+    QUIET_FLAG = 0,
+    DOUBLE_FLAG = 1,
+    KCASTLE_FLAG = 2,
+    QCASTLE_FLAG = 3,
+    CAPTURE_FLAG = 4,
+    EP_FLAG = 5,
+    PROMO_FLAG = 8
+};
+
 // encode move
-#define encode_move(source, target, piece, promoted, capture, double_adv, enpassant, castling) \
-    (source) | ((target) << 6) | ((piece) << 12) | ((promoted) << 16) | ((capture) << 20) |    \
-        ((double_adv) << 24) | ((enpassant) << 25) | ((castling) << 26)
-
-// extract source square, target square, piece, promoted piece, capture flag, double pawn push flag,
-// enpassant flag, and castling flag
-#define get_move_source(move) (move & 0x3f)
-#define get_move_target(move) ((move & 0xfc0) >> 6)
-#define get_move_piece(move) ((move & 0xf000) >> 12)
-#define get_move_promoted(move) ((move & 0xf0000) >> 16)
-#define get_move_captured(move) ((move & 0xf00000) >> 20)
-#define get_move_double(move) (move & 0x1000000)
-#define get_move_enpassant(move) (move & 0x2000000)
-#define get_move_castling(move) (move & 0x4000000)
+#define encode_move(source, target, flag) (Move)((source) | ((target) << 6) | ((flag) << 12))
+
+// Promotion flag for a given piece type (KNIGHT - QUEEN)
+#define promo_flag(type, capture) (PROMO_FLAG | ((capture) ? CAPTURE_FLAG : 0) | ((type) - KNIGHT))
+
+// extract source square, target square, flag, promoted piece type, capture flag, double pawn push
+// flag, enpassant flag, and castling flag
+#define get_move_source(move) ((move) & 0x3f)
+#define get_move_target(move) (((move) & 0xfc0) >> 6)
+#define get_move_flag(move) (((move) & 0xf000) >> 12)
+#define get_move_promoted(move) (((move) & 0x8000) ? KNIGHT + (get_move_flag(move) & 3) : NONE)
+#define get_move_capture(move) ((move) & 0x4000)
+#define get_move_double(move) (get_move_flag(move) == DOUBLE_FLAG)
+#define get_move_enpassant(move) (get_move_flag(move) == EP_FLAG)
+#define get_move_castling(move) \
+    (get_move_flag(move) == KCASTLE_FLAG || get_move_flag(move) == QCASTLE_FLAG)
+
+// Moving piece. Only valid before the move is made
+static inline uint8_t get_move_piece(const Board& pos, Move move) {
+    return pos.pieces[get_move_source(move)];
+}
+
+// Captured piece (EMPTY for quiets). Only valid before the move is made
+static inline uint8_t get_move_captured(const Board& pos, Move move) {
+    if (get_move_enpassant(move)) {
+        return (pos.side == WHITE) ? bP : wP;
+    }
+    return pos.pieces[get_move_target(move)];
+}
 
 #endif  // MOVEGEN_HPP
\ No newline at end of file
@@ -7,23 +7,29 @@
 #include <string>
 
 #include "../datatypes.hpp"
+#include "makemove.hpp"
 #include "movegen.hpp"
 
 // print move (for UCI purposes)
-std::string print_move(int move) {
+std::string print_move(Move move) {
+    // UCI null move, e.g. bestmove when there is no legal move
+    if (move == NO_MOVE) {
+        return "0000";
+    }
+
     std::ostringstream oss;
     oss << ascii_squares[get_move_source(move)] << ascii_squares[get_move_target(move)];
 
     // Promoted pieces must be encoded in lowercase
     if (get_move_promoted(move)) {
         int promoted_piece = get_move_promoted(move);
-        if (piece_type[promoted_piece] == QUEEN) {
+        if (promoted_piece == QUEEN) {
             oss << "q";
-        } else if (piece_type[promoted_piece] == ROOK) {
+        } else if (promoted_piece == ROOK) {
             oss << "r";
-        } else if (piece_type[promoted_piece] == BISHOP) {
+        } else if (promoted_piece == BISHOP) {
             oss << "b";
-        } else if (piece_type[promoted_piece] == KNIGHT) {
+        } else if (promoted_piece == KNIGHT) {
             oss << "n";
         }
     }
@@ -33,7 +39,7 @@ std::string print_move(int move) {
 
 // Parses user/GUI move string input (e.g. "e7e8q") and checks if its valid.
 // Returns the move if valid.
-int parse_move(const Board& pos, std::string move_string) {
+Move parse_move(const Board& pos, std::string move_string) {
     // Invalid move length
     if (move_string.length() < 4) {
         return 0;
@@ -48,20 +54,20 @@ int parse_move(const Board& pos, std::string move_string) {
 
     // Search if the move exists in the list
     for (uint16_t move_count = 0; move_count < move_list.length; move_count++) {
-        int move = move_list.moves[move_count].move;
+        Move move = move_list.moves[move_count].move;
 
         // make sure source & target squares are available within the generated move
         if (source_square == get_move_source(move) && target_square == get_move_target(move)) {
             int promoted_piece = get_move_promoted(move);
 
             if (promoted_piece) {
-                if (piece_type[promoted_piece] == QUEEN && move_string[4] == 'q') {
+                if (promoted_piece == QUEEN && move_string[4] == 'q') {
                     return move;
-                } else if (piece_type[promoted_piece] == ROOK && move_string[4] == 'r') {
+                } else if (promoted_piece == ROOK && move_string[4] == 'r') {
                     return move;
-                } else if (piece_type[promoted_piece] == BISHOP && move_string[4] == 'b') {
+                } else if (promoted_piece == BISHOP && move_string[4] == 'b') {
                     return move;
-                } else if (piece_type[promoted_piece] == KNIGHT && move_string[4] == 'n') {
+                } else if (promoted_piece == KNIGHT && move_string[4] == 'n') {
                     return move;
                 }
                 continue;  // continue the loop on possible wrong promotions (e.g. "e7e8f")
@@ -75,7 +81,7 @@ int parse_move(const Board& pos, std::string move_string) {
 }
 
 // print move list
-void print_move_list(const MoveList move_list, bool verbose = true) {
+void print_move_list(const Board& pos, const MoveList move_list, bool verbose = true) {
     // Do nothing on empty move list
     if (move_list.length == 0) {
         std::cout << "\n     No move in the move list!\n";
@@ -87,16 +93,16 @@ void print_move_list(const MoveList move_list, bool verbose = true) {
 
         // Loop over moves within a move list
         for (uint16_t move_count = 0; move_count < move_list.length; move_count++) {
-            Move move_struct = move_list.moves[move_count];
-            int move = move_struct.move;
+            ScoredMove move_struct = move_list.moves[move_count];
+            Move move = move_struct.move;
             int score = move_struct.score;
 
             // Print move with ASCII representation
             std::cout << "      " << ascii_squares[get_move_source(move)]
                       << ascii_squares[get_move_target(move)]
-                      << (get_move_promoted(move) ? ascii_pieces[get_move_promoted(move)] : ' ')
-                      << "   " << ascii_pieces[get_move_piece(move)] << "         "
-                      << ascii_pieces[get_move_captured(move)] << "         "
+                      << (get_move_promoted(move) ? ascii_pieces[get_move_promoted(move) + 6] : ' ')
+                      << "   " << ascii_pieces[get_move_piece(pos, move)] << "         "
+                      << ascii_pieces[get_move_captured(pos, move)] << "         "
                       << (get_move_double(move) ? 1 : 0) << "         "
                       << (get_move_enpassant(move) ? 1 : 0) << "         "
                       << (get_move_castling(move) ? 1 : 0) << "         " << score << "\n";
@@ -105,8 +111,8 @@ void print_move_list(const MoveList move_list, bool verbose = true) {
         std::cout << "Generated moves: ";
 
         for (uint16_t move_count = 0; move_count < move_list.length; move_count++) {
-            Move move_struct = move_list.moves[move_count];
-            int move = move_struct.move;
+            ScoredMove move_struct = move_list.moves[move_count];
+            Move move = move_struct.move;
             int score = move_struct.score;
             std::cout << print_move(move) << " (" << score << ") ";
         }
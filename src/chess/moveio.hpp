@@ -9,8 +9,8 @@
 #include "Board.hpp"
 #include "movegen.hpp"
 
-std::string print_move(int move);
-int parse_move(const Board& pos, std::string move_string);
-void print_move_list(const MoveList move_list, bool verbose);
+std::string print_move(Move move);
+Move parse_move(const Board& pos, std::string move_string);
+void print_move_list(const Board& pos, const MoveList move_list, bool verbose);
 
 #endif  // MOVEIO_HPP
\ No newline at end of file
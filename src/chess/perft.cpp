@@ -2,8 +2,16 @@
 
 #include "perft.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "../StaticVector.hpp"
 #include "../timeman.hpp"
@@ -14,55 +22,251 @@
 #include "movegen.hpp"
 #include "moveio.hpp"
 
-uint64_t run_perft(Board& pos, uint8_t depth, bool print_info) {
+// Unit of parallel work: a legal root move, and one legal reply to it (unless depth is 1)
+typedef struct {
+    int root;    // Index into the root move list
+    Move reply;  // NO_MOVE when the root move alone is the task
+} PerftTask;
+
+// Perft hash entry, shared by all workers without locks: the key is stored XORed with the data,
+// so an entry torn by a concurrent write fails verification instead of returning a wrong count
+typedef struct {
+    std::atomic<uint64_t> key;   // hash_key ^ data
+    std::atomic<uint64_t> data;  // depth in the top 8 bits, node count below
+} PerftEntry;
+
+typedef struct {
+    std::unique_ptr<PerftEntry[]> entries;
+    uint64_t max_entries;
+} PerftHash;
+
+static bool probe_perft_hash(const PerftHash& hash, uint64_t key, uint8_t depth, uint64_t& nodes) {
+    const PerftEntry& entry = hash.entries[key % hash.max_entries];
+    uint64_t data = entry.data.load(std::memory_order_relaxed);
+    if ((entry.key.load(std::memory_order_relaxed) ^ data) != key || (data >> 56) != depth) {
+        return false;
+    }
+    nodes = data & 0x00FFFFFFFFFFFFFFULL;
+    return true;
+}
+
+static void store_perft_hash(PerftHash& hash, uint64_t key, uint8_t depth, uint64_t nodes) {
+    PerftEntry& entry = hash.entries[key % hash.max_entries];
+    uint64_t data = ((uint64_t)depth << 56) | nodes;
+    entry.key.store(key ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+}
+
+// Single-threaded recursive walk
+static uint64_t perft(Board& pos, UndoStack& undo, uint8_t depth, PerftHash& hash) {
     if (depth == 0) {
-        return 0;
+        return 1;
     }
 
     uint64_t nodes = 0;
-    uint64_t start = 0;
-
     MoveList move_list;
     generate_moves(pos, move_list, false);
 
-    if (print_info) {
-        std::cout << "\n     Performance test\n\n";
-        start = get_time_ms();
+    // Bulk count the leaves: no need to make the last ply's moves
+    if (depth == 1) {
+        for (int move_count = 0; move_count < (int)move_list.length; ++move_count) {
+            nodes += is_legal_move(pos, move_list.moves[move_count].move);
+        }
+        return nodes;
+    }
+
+    if (hash.max_entries && probe_perft_hash(hash, pos.hash_key, depth, nodes)) {
+        return nodes;
     }
 
     for (int move_count = 0; move_count < (int)move_list.length; ++move_count) {
         // Skip illegal moves
-        if (!make_move(pos, move_list.moves[move_count].move)) {
+        if (!make_move(pos, undo, move_list.moves[move_count].move)) {
             continue;
         }
+        nodes += perft(pos, undo, depth - 1, hash);
+        take_move(pos, undo);
+    }
+
+    if (hash.max_entries) {
+        store_perft_hash(hash, pos.hash_key, depth, nodes);
+    }
+    return nodes;
+}
+
+uint64_t run_perft(const Board& root_pos, uint8_t depth, int threads, int hash_mb,
+                   bool print_info) {
+    if (depth == 0) {
+        return 0;
+    }
+
+    uint64_t start = 0;
+    if (print_info) {
+        std::cout << "\n     Performance test\n\n";
+        start = get_time_ms();
+    }
+
+    // Split the first two plies into tasks
+    Board pos = root_pos;
+    auto undo = std::make_unique<UndoStack>();
+    MoveList root_moves;
+    generate_moves(pos, root_moves, false);
 
-        uint64_t old_nodes = nodes;
+    std::vector<PerftTask> tasks;
+    std::vector<bool> root_legal(root_moves.length, false);
+    for (int root = 0; root < (int)root_moves.length; ++root) {
+        if (!make_move(pos, *undo, root_moves.moves[root].move)) {
+            continue;
+        }
+        root_legal[root] = true;
 
         if (depth == 1) {
-            nodes++;
+            tasks.push_back({root, NO_MOVE});
         } else {
-            nodes += run_perft(pos, depth - 1, false);
+            MoveList replies;
+            generate_moves(pos, replies, false);
+            for (int reply = 0; reply < (int)replies.length; ++reply) {
+                if (is_legal_move(pos, replies.moves[reply].move)) {
+                    tasks.push_back({root, replies.moves[reply].move});
+                }
+            }
         }
+        take_move(pos, *undo);
+    }
 
-        uint64_t new_nodes = nodes - old_nodes;
-
-        take_move(pos);
+    // Optional hash, shared by the workers
+    PerftHash hash = {nullptr, 0};
+    if (hash_mb > 0) {
+        hash.max_entries = (uint64_t)hash_mb * 0x100000 / sizeof(PerftEntry);
+        hash.entries = std::make_unique<PerftEntry[]>(hash.max_entries);
+    }
 
-        // Print move if root level
-        if (print_info) {
-            int move = move_list.moves[move_count].move;
-            std::cout << print_move(move) << ": " << new_nodes << "\n";
+    // Workers pull tasks in order until none are left
+    std::vector<uint64_t> task_nodes(tasks.size(), 0);
+    std::atomic<size_t> next_task = 0;
+    auto worker = [&]() {
+        Board worker_pos = root_pos;
+        auto worker_undo = std::make_unique<UndoStack>();
+        for (size_t t = next_task++; t < tasks.size(); t = next_task++) {
+            const PerftTask& task = tasks[t];
+            make_move(worker_pos, *worker_undo, root_moves.moves[task.root].move);
+            if (task.reply == NO_MOVE) {
+                task_nodes[t] = 1;
+            } else {
+                make_move(worker_pos, *worker_undo, task.reply);
+                task_nodes[t] = perft(worker_pos, *worker_undo, depth - 2, hash);
+                take_move(worker_pos, *worker_undo);
+            }
+            take_move(worker_pos, *worker_undo);
         }
+    };
+
+    threads = std::clamp(threads, 1, std::max((int)tasks.size(), 1));
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();  // The calling thread works too
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+
+    // Gather per root move, in move generation order
+    std::vector<uint64_t> root_nodes(root_moves.length, 0);
+    uint64_t nodes = 0;
+    for (size_t t = 0; t < tasks.size(); ++t) {
+        root_nodes[tasks[t].root] += task_nodes[t];
+        nodes += task_nodes[t];
     }
 
     // Print results if root level
     if (print_info) {
+        for (int root = 0; root < (int)root_moves.length; ++root) {
+            if (root_legal[root]) {
+                std::cout << print_move(root_moves.moves[root].move) << ": " << root_nodes[root]
+                          << "\n";
+            }
+        }
+
         uint64_t time = get_time_ms() - start;
+        int nps = int(nodes / (double)std::max(time, (uint64_t)1) * 1000);
         std::cout << "\n    Depth: " << (int)depth << "\n"
+                  << "  Threads: " << threads << "\n"
+                  << "     Hash: " << hash_mb << "MB\n"
                   << "    Nodes: " << nodes << "\n"
                   << "     Time: " << time << "ms (" << (double)time / 1000 << "s)\n"
-                  << "      NPS: " << int(nodes / (double)time * 1000) << "\n\n";
+                  << "      NPS: " << nps << "\n\n";
     }
 
     return nodes;
 }
+
+bool run_perft_suite(const std::string& path, int max_depth, int threads, int hash_mb) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Could not open perft suite " << path << "\n";
+        return false;
+    }
+
+    int positions = 0;
+    int failures = 0;
+    uint64_t total_nodes = 0;
+    uint64_t start = get_time_ms();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // Fields are separated by ';', the first being the FEN
+        std::istringstream fields(line);
+        std::string fen;
+        std::getline(fields, fen, ';');
+        fen.erase(fen.find_last_not_of(" \t\r") + 1);
+        if (fen.empty() || fen[0] == '#') {
+            continue;
+        }
+
+        Board pos;
+        parse_fen(pos, fen);
+        ++positions;
+
+        bool passed = true;
+        std::string field;
+        while (std::getline(fields, field, ';')) {
+            std::istringstream entry(field);
+            char tag = 0;
+            int depth = 0;
+            uint64_t expected = 0;
+            if (!(entry >> tag >> depth >> expected) || tag != 'D' || depth <= 0) {
+                continue;
+            }
+            if (max_depth > 0 && depth > max_depth) {
+                continue;
+            }
+
+            uint64_t nodes = run_perft(pos, depth, threads, hash_mb, false);
+            total_nodes += nodes;
+            if (nodes != expected) {
+                std::cout << "FAIL " << fen << "\n     Depth " << depth << ": expected "
+                          << expected << ", got " << nodes << "\n";
+                run_perft(pos, depth, threads, hash_mb, true);
+                passed = false;
+                break;  // Deeper counts would only repeat the same error
+            }
+        }
+
+        if (passed) {
+            std::cout << "ok   " << fen << "\n";
+        } else {
+            ++failures;
+        }
+    }
+
+    uint64_t time = get_time_ms() - start;
+    int nps = int(total_nodes / (double)std::max(time, (uint64_t)1) * 1000);
+    std::cout << "\n-#-#- Perft suite results -#-#-\n"
+              << "Positions: " << positions << " (" << failures << " failed)\n"
+              << "Execution time: " << time / 1000.0 << "s \n"
+              << total_nodes << " nodes " << nps << " nps\n"
+              << std::flush;
+
+    return failures == 0;
+}
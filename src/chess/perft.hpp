@@ -4,6 +4,7 @@
 #define PERFT_HPP
 
 #include <cstdint>
+#include <string>
 
 #include "Board.hpp"
 
@@ -24,6 +25,15 @@
 #define CPW_POS5 "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8"
 #define CPW_POS6 "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
 
-uint64_t run_perft(Board& pos, uint8_t depth, bool print_info);
+// Count the leaves of the legal move tree. The first two plies are split into tasks that
+// `threads` workers share, each on its own copy of the board. The last ply is bulk counted, and
+// with hash_mb > 0 subtree counts are cached by (hash_key, depth) in a table shared by the workers.
+// With print_info, prints the node count of every root move (divide) and a summary.
+uint64_t run_perft(const Board& pos, uint8_t depth, int threads, int hash_mb, bool print_info);
+
+// Check every "FEN ;D1 n ;D2 n ..." line of an EPD file (depths above max_depth are skipped when
+// it is non-zero). Prints the divide of each failing position and the aggregate NPS.
+// Returns true if all counts matched.
+bool run_perft_suite(const std::string& path, int max_depth, int threads, int hash_mb);
 
 #endif  // PERFT_HPP
\ No newline at end of file
@@ -2,36 +2,130 @@
 
 #include "zobrist.hpp"
 
+#include <array>
 #include <cstdint>
-#include <random>
+#include <utility>
 
 #include "Board.hpp"
+#include "attackgen.hpp"
+#include "bitboard.hpp"
+#include "movegen.hpp"
 
-// Init globals
-uint64_t piece_keys[13][64] = {{0}};  // random piece keys [piece][square]
-uint64_t castle_keys[16] = {0};       // random castling keys
-uint64_t side_key = 0ULL;             // random side key, indicating white to move
+/*
+    Zobrist keys, generated at compile time
+*/
 
-static inline uint64_t generate_random_U64(uint32_t seed) {
-    std::mt19937_64 engine(seed);  // 64-bit Mersenne Twister (Period length: 2^19937 - 1)
-    std::uniform_int_distribution<uint64_t> distribution(0, UINT64_MAX);
-    return distribution(engine);
+// First output of std::mt19937_64 seeded with `seed`, which is also what
+// std::uniform_int_distribution<uint64_t>(0, UINT64_MAX) returns for it. Only
+// state words 0, 1 and 156 feed the first twisted word, so seeding stops there.
+static constexpr uint64_t generate_random_U64(uint32_t seed) {
+    constexpr int MT_SHIFT = 156;  // Middle word offset (m)
+    std::array<uint64_t, MT_SHIFT + 1> state = {};
+
+    state[0] = seed;
+    for (int i = 1; i <= MT_SHIFT; ++i) {
+        state[i] = 6364136223846793005ULL * (state[i - 1] ^ (state[i - 1] >> 62)) + i;
+    }
+
+    // Twist word 0
+    uint64_t x = (state[0] & 0xFFFFFFFF80000000ULL) | (state[1] & 0x7FFFFFFFULL);
+    uint64_t y = state[MT_SHIFT] ^ (x >> 1) ^ ((x & 1) ? 0xB5026F5AA96619E9ULL : 0ULL);
+
+    // Temper
+    y ^= (y >> 29) & 0x5555555555555555ULL;
+    y ^= (y << 17) & 0x71D67FFFEDA60000ULL;
+    y ^= (y << 37) & 0xFFF7EEE000000000ULL;
+    y ^= y >> 43;
+    return y;
 }
 
-void init_hash_keys() {
-    // Space out seeds to avoid collisions (0, 10000, 20000)
+// Space out seeds to avoid collisions (0, 10000, 20000)
+static constexpr std::array<std::array<uint64_t, 64>, 13> init_piece_keys() {
+    std::array<std::array<uint64_t, 64>, 13> keys = {};
     for (int pce = 0; pce < 13; ++pce) {
         for (int sq = 0; sq < 64; ++sq) {
-            unsigned int seed = pce * 64 + sq;  // Deterministic seed for each piece and square
-            piece_keys[pce][sq] = generate_random_U64(seed);
+            // Deterministic seed for each piece and square
+            keys[pce][sq] = generate_random_U64(pce * 64 + sq);
         }
     }
-    side_key = generate_random_U64(10000);
+    return keys;
+}
+
+static constexpr std::array<uint64_t, 16> init_castle_keys() {
+    std::array<uint64_t, 16> keys = {};
     for (int index = 0; index < 16; ++index) {
-        castle_keys[index] = generate_random_U64(20000 + index);  // Seed based on index
+        keys[index] = generate_random_U64(20000 + index);  // Seed based on index
     }
+    return keys;
 }
 
+constexpr std::array<std::array<uint64_t, 64>, 13> piece_keys = init_piece_keys();
+constexpr std::array<uint64_t, 16> castle_keys = init_castle_keys();
+constexpr uint64_t side_key = generate_random_U64(10000);
+
+/*
+    Cuckoo tables, generated at compile time
+*/
+
+typedef struct {
+    std::array<uint64_t, CUCKOO_SIZE> keys;
+    std::array<Move, CUCKOO_SIZE> moves;
+    int count;  // Moves inserted
+} CuckooTables;
+
+// Can a piece of this type go from sq1 to sq2 on an empty board?
+static constexpr bool is_piece_move(int type, int sq1, int sq2) {
+    bool straight = GET_FILE(sq1) == GET_FILE(sq2) || GET_RANK(sq1) == GET_RANK(sq2);
+    switch (type) {
+        case KNIGHT:
+            return GET_BIT(knight_attacks[sq1], sq2);
+        case BISHOP:
+            return line_masks[sq1][sq2] && !straight;
+        case ROOK:
+            return line_masks[sq1][sq2] && straight;
+        case QUEEN:
+            return line_masks[sq1][sq2];
+        case KING:
+            return GET_BIT(king_attacks[sq1], sq2);
+    }
+    return false;
+}
+
+static constexpr CuckooTables init_cuckoo_tables() {
+    CuckooTables tables = {};
+
+    for (int pce = wN; pce <= bK; ++pce) {
+        int type = (pce <= wK) ? pce : pce - 6;
+        if (type == PAWN) continue;
+
+        for (int sq1 = 0; sq1 < 64; ++sq1) {
+            for (int sq2 = sq1 + 1; sq2 < 64; ++sq2) {
+                if (!is_piece_move(type, sq1, sq2)) continue;
+
+                // Both directions of the move share one entry; a move also flips the side key
+                uint64_t key = piece_keys[pce][sq1] ^ piece_keys[pce][sq2] ^ side_key;
+                Move move = encode_move(sq1, sq2, QUIET_FLAG);
+
+                // Insert, kicking out residents to their other slot until an empty slot is found
+                int index = cuckoo_h1(key);
+                while (true) {
+                    std::swap(tables.keys[index], key);
+                    std::swap(tables.moves[index], move);
+                    if (!move) break;  // Landed in an empty slot
+                    index = (index == cuckoo_h1(key)) ? cuckoo_h2(key) : cuckoo_h1(key);
+                }
+                ++tables.count;
+            }
+        }
+    }
+    return tables;
+}
+
+static constexpr CuckooTables cuckoo_tables = init_cuckoo_tables();
+static_assert(cuckoo_tables.count == 3668, "There are 3668 reversible piece moves");
+constexpr std::array<uint64_t, CUCKOO_SIZE> cuckoo_keys = cuckoo_tables.keys;
+constexpr std::array<Move, CUCKOO_SIZE> cuckoo_moves = cuckoo_tables.moves;
+
 uint64_t generate_hash_key(const Board& pos) {
     uint64_t final_key = 0ULL;
 
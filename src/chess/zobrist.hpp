@@ -3,14 +3,25 @@
 #ifndef ZOBRIST_HPP
 #define ZOBRIST_HPP
 
+#include <array>
+
 #include "Board.hpp"
 
-extern uint64_t piece_keys[13][64];  // random piece keys [piece][square]
-extern uint64_t castle_keys[16];     // random castling keys
-extern uint64_t side_key;            // random side key
+// Generated at compile time in zobrist.cpp
+extern const std::array<std::array<uint64_t, 64>, 13> piece_keys;  // [piece][square]
+extern const std::array<uint64_t, 16> castle_keys;                 // random castling keys
+extern const uint64_t side_key;  // random side key, indicating white to move
+
+// Cuckoo tables of every reversible (non-pawn) piece move, keyed by the hash difference the move
+// makes. Used to detect upcoming repetitions (Marcel van Kervinck's method)
+constexpr int CUCKOO_SIZE = 8192;
+constexpr int cuckoo_h1(uint64_t key) { return key & 0x1FFF; }
+constexpr int cuckoo_h2(uint64_t key) { return (key >> 16) & 0x1FFF; }
+
+extern const std::array<uint64_t, CUCKOO_SIZE> cuckoo_keys;
+extern const std::array<Move, CUCKOO_SIZE> cuckoo_moves;
 
 // Functions
-void init_hash_keys();
 uint64_t generate_hash_key(const Board& pos);
 
 #endif  // ZOBRIST_HPP
\ No newline at end of file
@@ -3,10 +3,12 @@
 #ifndef DATATYPES_HPP
 #define DATATYPES_HPP
 
+#include <array>
 #include <cstdint>
 #include <string>
 
 typedef unsigned long long Bitboard;
+typedef uint16_t Move;  // See movegen.hpp for the bit layout
 
 constexpr uint8_t MAX_DEPTH = 64;
 constexpr int INF_BOUND = 30000;
@@ -21,19 +23,13 @@ enum { WHITE, BLACK, BOTH };
 // Pieces
 enum { EMPTY, wP, wN, wB, wR, wQ, wK, bP, bN, bB, bR, bQ, bK };
 enum { NONE, PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING };
-extern int piece_type[13];
-extern int piece_col[13];
-extern bool piece_big[13];
-extern bool piece_maj[13];
-extern bool piece_min[13];
+extern const int piece_type[13];
+extern const int piece_col[13];
+extern const bool piece_big[13];
+extern const bool piece_maj[13];
+extern const bool piece_min[13];
 
-extern int Mirror64[64];
-
-extern Bitboard file_masks[8];
-extern Bitboard rank_masks[8];
-extern Bitboard adjacent_files[8];
-extern Bitboard white_passer_masks[64];
-extern Bitboard black_passer_masks[64];
+extern const int Mirror64[64];
 
 const std::string ascii_pieces = ".PNBRQKpnbrqk";
 
@@ -62,12 +58,58 @@ const std::string ascii_squares[] = {
 enum { FILE_A, FILE_B, FILE_C, FILE_D, FILE_E, FILE_F, FILE_G, FILE_H };
 enum { RANK_8, RANK_7, RANK_6, RANK_5, RANK_4, RANK_3, RANK_2, RANK_1 };
 
+/*
+    File, rank and passed pawn masks, generated at compile time
+*/
+
+constexpr std::array<Bitboard, 8> make_file_masks() {
+    std::array<Bitboard, 8> masks = {};
+    for (int file = FILE_A; file <= FILE_H; ++file) masks[file] = 0x0101010101010101ULL << file;
+    return masks;
+}
+
+constexpr std::array<Bitboard, 8> make_rank_masks() {
+    std::array<Bitboard, 8> masks = {};
+    for (int rank = RANK_8; rank <= RANK_1; ++rank) masks[rank] = 0xFFULL << (rank * 8);
+    return masks;
+}
+
+inline constexpr std::array<Bitboard, 8> file_masks = make_file_masks();
+inline constexpr std::array<Bitboard, 8> rank_masks = make_rank_masks();
+
+constexpr std::array<Bitboard, 8> make_adjacent_files() {
+    std::array<Bitboard, 8> masks = {};
+    for (int file = FILE_A; file <= FILE_H; ++file) {
+        if (file > FILE_A) masks[file] |= file_masks[file - 1];
+        if (file < FILE_H) masks[file] |= file_masks[file + 1];
+    }
+    return masks;
+}
+
+inline constexpr std::array<Bitboard, 8> adjacent_files = make_adjacent_files();
+
+// Squares ahead of a pawn of `side` on its own and adjacent files [square]
+constexpr std::array<Bitboard, 64> make_passer_masks(int side) {
+    std::array<Bitboard, 64> masks = {};
+    for (int sq = 0; sq < 64; ++sq) {
+        Bitboard span = file_masks[sq % 8] | adjacent_files[sq % 8];
+        for (int target = 0; target < 64; ++target) {
+            bool ahead = (side == WHITE) ? (target / 8 < sq / 8) : (target / 8 > sq / 8);
+            if (ahead) masks[sq] |= span & (1ULL << target);
+        }
+    }
+    return masks;
+}
+
+inline constexpr std::array<Bitboard, 64> white_passer_masks = make_passer_masks(WHITE);
+inline constexpr std::array<Bitboard, 64> black_passer_masks = make_passer_masks(BLACK);
+
 enum { WKCA = 1, WQCA = 2, BKCA = 4, BQCA = 8 };
 
 typedef struct {
     int length;
     int score;
-    int moves[MAX_DEPTH];
+    Move moves[MAX_DEPTH];
 } PVLine;  // Candidate / best principal variation line
 
 #endif  // DATATYPES_HPP
\ No newline at end of file
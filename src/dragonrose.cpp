@@ -1,24 +1,24 @@
 // dragonrose.cpp
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>  // For exit
 #include <cstring>  // For strncmp
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 
 #include "UciHandler.hpp"
 #include "chess/Board.hpp"
 #include "chess/bench.hpp"
+#include "chess/perft.hpp"
 #include "eval/evaluate.hpp"
-#include "init.hpp"
 #include "search.hpp"
 #include "timeman.hpp"
 #include "ttable.hpp"
 
 int main(int argc, char *argv[]) {
-    init_all();
-
     auto pos = std::make_unique<Board>();
     reset_board(*pos);
     auto info = std::make_unique<SearchInfo>();
@@ -30,14 +30,55 @@ int main(int argc, char *argv[]) {
 
     // Handle CLI Arguments
     for (int arg_num = 0; arg_num < argc; ++arg_num) {
+        // bench [depth] [hash] [threads] [file] [json|csv] [perf]
         if (strncmp(argv[arg_num], "bench", 5) == 0) {
-            run_bench(*pos, *hash_table, *info, uci);
-            return EXIT_SUCCESS;
+            BenchConfig config;
+            int numbers = 0;
+            for (int bench_arg = arg_num + 1; bench_arg < argc; ++bench_arg) {
+                std::string arg = argv[bench_arg];
+                if (arg == "json") {
+                    config.format = BENCH_JSON;
+                } else if (arg == "csv") {
+                    config.format = BENCH_CSV;
+                } else if (arg == "perf") {
+                    config.perf = true;
+                } else if (arg.find_first_not_of("0123456789") == std::string::npos) {
+                    // Numbers fill depth, hash and threads in order
+                    int value = atoi(arg.c_str());
+                    if (numbers == 0) {
+                        config.depth = std::clamp(value, 1, (int)MAX_DEPTH - 1);
+                    } else if (numbers == 1) {
+                        config.hash_size = value;
+                    } else if (numbers == 2) {
+                        config.threads = value;
+                    }
+                    ++numbers;
+                } else {
+                    config.file = arg;
+                }
+            }
+            bool done = run_bench(*pos, *hash_table, *info, uci, config);
+            return done ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        // perftsuite <file.epd> [max depth] [threads] [hash MB]
+        if (strncmp(argv[arg_num], "perftsuite", 10) == 0) {
+            if (arg_num + 1 >= argc) {
+                std::cerr << "Usage: " << argv[0]
+                          << " perftsuite <file.epd> [max depth] [threads] [hash MB]\n";
+                return EXIT_FAILURE;
+            }
+            int max_depth = (arg_num + 2 < argc) ? atoi(argv[arg_num + 2]) : 0;
+            int threads = (arg_num + 3 < argc) ? atoi(argv[arg_num + 3])
+                                               : std::max(1u, std::thread::hardware_concurrency());
+            int hash_mb = (arg_num + 4 < argc) ? atoi(argv[arg_num + 4]) : 0;
+            bool passed = run_perft_suite(argv[arg_num + 1], max_depth, threads, hash_mb);
+            return passed ? EXIT_SUCCESS : EXIT_FAILURE;
         }
     }
 
     // Enter UCI loop immediately
     uci.uci_loop(*pos, *hash_table, *info, &options);
+    free_hash_table(*hash_table);  // Leaves (and if last, removes) a shared-memory table
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
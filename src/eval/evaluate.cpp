@@ -408,8 +408,7 @@ static inline int evaluate_pawn_shield(const Board& pos, uint8_t pce, uint8_t ki
     // Pawn shield only applies if the king is castled
     if (!uncastled_king) {
         uint8_t ally_pawns = (king_colour == WHITE) ? wP : bP;
-        Bitboard shield_mask =
-            generate_shield_zone(king_sq, king_colour) & pos.bitboards[ally_pawns];
+        Bitboard shield_mask = shield_zones[king_colour][king_sq] & pos.bitboards[ally_pawns];
 
         for (int file = king_file - 1; file <= king_file + 1; ++file) {
             if (file >= FILE_A && file <= FILE_H) {
@@ -489,23 +488,24 @@ static inline int evaluate_kings(const Board& pos, uint8_t pce, int phase) {
 static inline int16_t count_tempi(const Board& pos) {
     uint8_t white_adv = 20;  // White's first-move advantage
     uint8_t tempo = 8;       // Value of a typical tempo
-    Bitboard UNDEVELOPED_WHITE_ROOKS = (1ULL << a1) | (1ULL << h1);
-    Bitboard UNDEVELOPED_BLACK_ROOKS = (1ULL << a8) | (1ULL << h8);
+    constexpr Bitboard UNDEVELOPED_WHITE_ROOKS = (1ULL << a1) | (1ULL << h1);
+    constexpr Bitboard UNDEVELOPED_BLACK_ROOKS = (1ULL << a8) | (1ULL << h8);
+    constexpr Bitboard UNMOVED_WHITE_DE_PAWNS = (1ULL << d2) | (1ULL << e2);
+    constexpr Bitboard UNMOVED_BLACK_DE_PAWNS = (1ULL << d7) | (1ULL << e7);
+    constexpr Bitboard DE_FILES = file_masks[FILE_D] | file_masks[FILE_E];
 
     int8_t net_developed_pieces = 0;
-    Bitboard white_DE_pawns = pos.bitboards[wP] & (file_masks[FILE_D] | file_masks[FILE_E]);
+    Bitboard white_DE_pawns = pos.bitboards[wP] & DE_FILES;
     Bitboard white_NBQ = pos.bitboards[wN] | pos.bitboards[wB] | pos.bitboards[wQ];
-    Bitboard black_DE_pawns = pos.bitboards[bP] & (file_masks[FILE_D] | file_masks[FILE_E]);
+    Bitboard black_DE_pawns = pos.bitboards[bP] & DE_FILES;
     Bitboard black_NBQ = pos.bitboards[bN] | pos.bitboards[bB] | pos.bitboards[bQ];
 
     net_developed_pieces += count_bits(white_NBQ & DEVELOPMENT_MASK);                  // wN, wB, wQ
     net_developed_pieces += count_bits(pos.bitboards[wR] & ~UNDEVELOPED_WHITE_ROOKS);  // wR
-    net_developed_pieces +=
-        count_bits(white_DE_pawns & ~bits_between_squares(d2, e2));    // wP (centre pawns)
+    net_developed_pieces += count_bits(white_DE_pawns & ~UNMOVED_WHITE_DE_PAWNS);  // wP (centre)
     net_developed_pieces -= count_bits(black_NBQ & DEVELOPMENT_MASK);  // bN, bB, bQ
     net_developed_pieces -= count_bits(pos.bitboards[bR] & ~UNDEVELOPED_BLACK_ROOKS);  // bR
-    net_developed_pieces -=
-        count_bits(black_DE_pawns & ~bits_between_squares(d7, e7));  // bP (centre pawns)
+    net_developed_pieces -= count_bits(black_DE_pawns & ~UNMOVED_BLACK_DE_PAWNS);  // bP (centre)
 
     return ((pos.side == WHITE) ? white_adv : 0) + net_developed_pieces * tempo;
 }
@@ -1,8 +0,0 @@
-// init.hpp
-
-#ifndef INIT_HPP
-#define INIT_HPP
-
-void init_all();
-
-#endif  // INIT_HPP
\ No newline at end of file
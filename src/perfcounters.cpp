@@ -0,0 +1,114 @@
+// perfcounters.cpp
+
+#include "perfcounters.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* perf_counter_names[PERF_COUNTERS_NB] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"};
+
+#ifdef __linux__
+
+// Cache events are encoded as cache id | (op << 8) | (result << 16)
+static constexpr uint64_t cache_event(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} perf_events[PERF_COUNTERS_NB] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+bool open_perf_counters(PerfCounters& counters) {
+    bool any_open = false;
+    counters.error.clear();
+    for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = perf_events[i].type;
+        attr.config = perf_events[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // Counters share the PMU; when it is oversubscribed they are time-multiplexed and scaled
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        counters.values[i] = 0;
+        counters.fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counters.fds[i] < 0) {
+            counters.error = strerror(errno);
+        } else {
+            any_open = true;
+        }
+    }
+    return any_open;
+}
+
+void start_perf_counters(PerfCounters& counters) {
+    for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+        if (counters.fds[i] >= 0) {
+            ioctl(counters.fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters.fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void stop_perf_counters(PerfCounters& counters) {
+    for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+        if (counters.fds[i] >= 0) {
+            ioctl(counters.fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+        uint64_t data[3];  // value, time enabled, time running
+        if (counters.fds[i] < 0 || read(counters.fds[i], data, sizeof(data)) != sizeof(data)) {
+            continue;
+        }
+        if (data[2] > 0 && data[2] < data[1]) {
+            data[0] = (uint64_t)((double)data[0] * data[1] / data[2]);
+        }
+        counters.values[i] += data[0];
+    }
+}
+
+void close_perf_counters(PerfCounters& counters) {
+    for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+        if (counters.fds[i] >= 0) {
+            close(counters.fds[i]);
+            counters.fds[i] = -1;
+        }
+    }
+}
+
+#else
+
+bool open_perf_counters(PerfCounters& counters) {
+    for (int i = 0; i < PERF_COUNTERS_NB; ++i) {
+        counters.fds[i] = -1;
+        counters.values[i] = 0;
+    }
+    counters.error = "perf_event_open is Linux only";
+    return false;
+}
+
+void start_perf_counters(PerfCounters&) {}
+void stop_perf_counters(PerfCounters&) {}
+void close_perf_counters(PerfCounters&) {}
+
+#endif
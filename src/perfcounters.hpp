@@ -0,0 +1,35 @@
+// perfcounters.hpp
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <cstdint>
+#include <string>
+
+// Hardware counters read through Linux perf_event_open (user space only)
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_COUNTERS_NB
+};
+
+extern const char* perf_counter_names[PERF_COUNTERS_NB];
+
+typedef struct {
+    int fds[PERF_COUNTERS_NB];          // -1 when a counter could not be opened
+    uint64_t values[PERF_COUNTERS_NB];  // Accumulated over every start/stop pair
+    std::string error;                  // Why counters are missing, if any are
+} PerfCounters;
+
+// Counters that fail to open (no PMU in a container or VM, perf_event_paranoid, not Linux) are
+// left out; returns false if none could be opened
+bool open_perf_counters(PerfCounters& counters);
+void start_perf_counters(PerfCounters& counters);
+void stop_perf_counters(PerfCounters& counters);
+void close_perf_counters(PerfCounters& counters);
+
+#endif  // PERFCOUNTERS_HPP
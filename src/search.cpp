@@ -5,7 +5,11 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 #include "Board.hpp"
 #include "attack.hpp"
@@ -18,141 +22,351 @@
 #include "search_params.hpp"
 #include "timeman.hpp"
 #include "ttable.hpp"
-
-int LMR_reduction_table[MAX_DEPTH][MAX_PSEUDO_MOVES][2];
+#include "zobrist.hpp"
 
 // Function prototypes
 static inline void check_up(SearchInfo& info, bool soft_limit);
-static inline int check_draw(const Board& pos, bool qsearch);
+static inline int check_draw(const Board& pos, const UndoStack& undo, bool qsearch);
+static inline bool upcoming_repetition(const Board& pos, const UndoStack& undo);
 static void clear_search_vars(Board& pos, HashTable& table, SearchInfo& info);
 
+static void init_root_moves(Board& pos, const HashTable& table, SearchInfo& info);
 static inline void init_PVLine(PVLine* line);
-static inline void update_best_line(Board& pos, PVLine* pv);
+static inline void update_best_line(SearchInfo& info, PVLine* pv);
+static void extend_PV_line(Board& pos, UndoStack& undo, const HashTable& table, PVLine& pv,
+                           int depth);
 
 static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& info, int alpha,
                                     int beta, int depth, PVLine* line, bool do_null, bool PV_node);
+static int aspiration_search(Board& pos, HashTable& table, SearchInfo& info, int depth, int guess,
+                             PVLine* pv);
+static void report_search_info(const SearchInfo& info, const HashTable& table, uint8_t depth,
+                               int multipv, const PVLine& pv, int score);
+static Move unfinished_best_move(Board& pos, const HashTable& table, SearchInfo& info);
+static void report_best_move(Board& pos, const HashTable& table, SearchInfo& info,
+                             Move best_move);
 
 /*
         Iterative deepening loop
 */
 
 void search_position(Board& pos, HashTable& table, SearchInfo& info) {
-    int best_score = -INF_BOUND;
-    int best_move = NO_MOVE;
+    Move best_move = NO_MOVE;
 
     clear_search_vars(pos, table, info);  // Initialise searchHistory and killers
+    init_root_moves(pos, table, info);
 
-    // Aspiration windows variables
-    uint8_t window_size = ASP_WIN_SIZE;
-    int guess = -INF_BOUND;
-    int alpha = -INF_BOUND;
-    int beta = INF_BOUND;
-
-    uint8_t curr_depth = 1;
-    do {
-        PVLine pv;  // Stores the best PV in the search depth so far. Merges with PV of child nodes if it's good
+    // Checkmate or stalemate: nothing to search
+    if (info.root_moves.length == 0) {
+        PVLine pv;
         init_PVLine(&pv);
+        if (info.print_info) {
+            report_search_info(info, table, 0, 0, pv, pos.checkers ? -INF_BOUND : 0);
+        }
+        report_best_move(pos, table, info, NO_MOVE);
+        return;
+    }
 
-        /*
-            Aspiration windows
-        */
-
-        // Do a full-window search for the first few depths as they are unstable
-        if (curr_depth < ASP_WIN_DEPTH) {
-            best_score = negamax_alphabeta(pos, table, info, -INF_BOUND, INF_BOUND, curr_depth, &pv,
-                                           true, true);
-        } else {
-            alpha = std::max(-INF_BOUND, guess - window_size);
-            beta = std::min(guess + window_size, INF_BOUND);
-            int delta = window_size;
-
-            // Aspiration windows algorithm adapted from Ethereal by Andrew Grant
-            bool reSearch = true;
-            while (reSearch) {
-                best_score =
-                    negamax_alphabeta(pos, table, info, alpha, beta, curr_depth, &pv, true, true);
-
-                // Stop researches when out of time
-                if (info.stopped && curr_depth > 1) {
-                    break;
-                }
+    // MultiPV: one line per root move at most
+    const int num_lines =
+        std::min({(int)info.multipv, (int)info.root_moves.length, (int)MAX_MULTIPV});
+    RootMove* root_begin = info.root_moves.moves;
+    RootMove* root_end = info.root_moves.moves + info.root_moves.length;
 
-                // Re-search with a wider window on the side that fails
-                if (best_score <= alpha) {
-                    // Slide the window down
-                    beta = (alpha + beta) / 2;
-                    alpha = std::max(-INF_BOUND, alpha - delta);
-                } else if (best_score >= beta) {
-                    // Increase beta and not touch alpha
-                    beta = std::min(beta + delta, INF_BOUND);
-                }
-                // Search falls within expected bounds
-                else {
-                    reSearch = false;
-                }
+    // Best move stability, for time management
+    Move previous_best = NO_MOVE;
+    int stability = 0;
 
-                delta = delta + delta / 2;  // Expand the search window
+    uint8_t curr_depth = 1;
+    do {
+        uint64_t iteration_start_nodes = info.nodes;
+        uint64_t iteration_start_time = get_time_ms();
+
+        // Root move order: the lines of the last iteration, then the moves that took the most
+        // nodes so far (mostly in the last iteration), as they are the hardest to refute
+        for (RootMove* root_move = root_begin; root_move != root_end; ++root_move) {
+            root_move->previous_score = root_move->score;
+            root_move->score = -INF_BOUND;
+        }
+        std::stable_sort(root_begin + num_lines, root_end,
+                         [](const RootMove& a, const RootMove& b) { return a.nodes > b.nodes; });
+
+        // Search the root once per line, leaving out the root moves of the lines above. The TT is
+        // shared, so the later lines mostly re-use the work of the first
+        for (info.pv_index = 0; info.pv_index < num_lines; ++info.pv_index) {
+            PVLine pv;
+            init_PVLine(&pv);
+            aspiration_search(pos, table, info, curr_depth,
+                              info.root_moves.moves[info.pv_index].previous_score, &pv);
+
+            if (info.stopped) {
+                break;
             }
         }
 
-        // Make sure at least depth 1 is completed before breaking
-        if (info.stopped && curr_depth > 1) {
+        // An unfinished iteration is thrown away, except for the lines of depth 1 that finished:
+        // the moves left unsearched have no score
+        const int finished_lines = info.stopped ? info.pv_index : num_lines;
+        if (info.stopped && (curr_depth > 1 || finished_lines == 0)) {
             break;
         }
 
-        update_best_line(pos, &pv);
-        guess = best_score;
+        // Later lines can come back with better scores than the lines above them
+        std::stable_sort(root_begin, root_begin + finished_lines,
+                         [](const RootMove& a, const RootMove& b) { return a.score > b.score; });
+
+        // A TT cutoff in a PV node (common in the later MultiPV lines, which search the positions
+        // of the first) ends the line early. Single-PV output is left as it was
+        if (num_lines > 1) {
+            for (int line = 0; line < finished_lines; ++line) {
+                extend_PV_line(pos, info.undo, table, info.root_moves.moves[line].pv, curr_depth);
+            }
+        }
+
+        update_best_line(info, &info.root_moves.moves[0].pv);
+        info.stats.iteration_nodes[curr_depth] = info.nodes - iteration_start_nodes;
+        uint64_t iteration_time = get_time_ms() - iteration_start_time;
 
         // Search exited early as hash move found
         if (info.nodes == 0) {
             // Fallback to getting PV from TT
-            get_PV_line(pos, table, curr_depth);
+            get_PV_line(pos, info.undo, table, info.PV_array, curr_depth);
+        }
+        best_move = info.PV_array.moves[0];
+
+        // Scale the soft limit by how settled the best move is
+        stability = (best_move == previous_best) ? stability + 1 : 0;
+        previous_best = best_move;
+        if (info.timeset && info.soft_time && curr_depth >= SOFT_SCALE_DEPTH) {
+            uint64_t soft_time = scale_soft_time(info.soft_time, stability,
+                                                 info.root_moves.moves[0].nodes, info.nodes);
+            info.soft_stop_time = std::min(info.start_time + soft_time, info.hard_stop_time);
         }
-        best_move = pos.PV_array.moves[0];
-
-        // Display mate if there's forced mate
-        uint64_t time = get_time_ms() - info.start_time;  // in ms
-        uint64_t nps = static_cast<uint64_t>((info.nodes / (time + 0.01)) * 1000.0);  // Add 0.01ms to prevent division by zero error
 
-        int8_t mate_moves = 0;
+        if (info.print_info) {
+            if (num_lines == 1) {
+                report_search_info(info, table, curr_depth, 0, info.PV_array,
+                                   info.root_moves.moves[0].score);
+            } else {
+                for (int line = 0; line < finished_lines; ++line) {
+                    const RootMove& root_move = info.root_moves.moves[line];
+                    report_search_info(info, table, curr_depth, line + 1, root_move.pv,
+                                       root_move.score);
+                }
+            }
 
-        if (abs(best_score) >= MATE_SCORE) {
-            auto sgn = [](int v) { return v >= 0 ? 1 : -1; };
-            mate_moves = round((INF_BOUND - abs(best_score) - 1) / 2 + 1) * sgn(best_score);
-            std::cout << "info depth " << (int)curr_depth << " seldepth " << (int)info.seldepth
-                      << " score mate " << (int)mate_moves << " nodes " << info.nodes << " nps "
-                      << nps << " hashfull " << table.num_entries * 1000 / table.max_entries
-                      << " time " << time << " pv";
-        } else {
-            std::cout << "info depth " << (int)curr_depth << " seldepth " << (int)info.seldepth
-                      << " score cp " << best_score << " nodes " << info.nodes << " nps " << nps
-                      << " hashfull " << table.num_entries * 1000 / table.max_entries << " time "
-                      << time << " pv";
+#ifdef SEARCH_STATS
+            send_line(search_stats_info(info.stats, curr_depth));
+#endif
         }
 
-        // Print PV
-        for (int i = 0; i < pos.PV_array.length; ++i) {
-            std::cout << " " << print_move(pos.PV_array.moves[i]);
+        if (info.stopped) {
+            break;
         }
-        std::cout << "\n" << std::flush;  // Make sure it outputs depth-by-depth to GUI
 
         curr_depth++;  // Increment depth
         check_up(info, true);
+
+        // While pondering, search on past the soft limit but play as soon as the ponderhit comes
+        if (info.ponder_search && info.timeset && get_time_ms() > info.soft_stop_time) {
+            info.stop_on_ponderhit = true;
+        }
+
+        // Don't start an iteration that is not expected to finish before the hard limit: an
+        // unfinished iteration is thrown away, and the time saved stays on the clock
+        if (info.soft_time && !info.soft_stopped && !info.ponder_search) {
+            uint64_t predicted_time =
+                predict_iteration_time(iteration_time, info.stats.iteration_nodes[curr_depth - 1],
+                                       info.stats.iteration_nodes[curr_depth - 2]);
+            if (get_time_ms() + predicted_time > info.hard_stop_time) {
+                info.soft_stopped = true;
+            }
+        }
     } while (curr_depth <= info.depth && !info.soft_stopped);
 
-    std::cout << "bestmove " << print_move(best_move) << "\n" << std::flush;
+    if (best_move == NO_MOVE) {
+        best_move = unfinished_best_move(pos, table, info);
+    }
+
+    report_best_move(pos, table, info, best_move);
+}
+
+// Move to play when stopped before a line of depth 1 finished: the hash move if it is a root move,
+// else the best root move searched so far, else the one with the best static eval
+static Move unfinished_best_move(Board& pos, const HashTable& table, SearchInfo& info) {
+    RootMove* root_begin = info.root_moves.moves;
+    RootMove* root_end = info.root_moves.moves + info.root_moves.length;
+
+    const Move hash_move = probe_PV_move(pos, table);
+    if (std::any_of(root_begin, root_end,
+                    [hash_move](const RootMove& m) { return m.move == hash_move; })) {
+        return hash_move;
+    }
+
+    const RootMove* best = std::max_element(
+        root_begin, root_end, [](const RootMove& a, const RootMove& b) { return a.score < b.score; });
+    if (best->score > -INF_BOUND) {
+        return best->move;
+    }
+
+    Move best_move = root_begin->move;
+    int best_score = -INF_BOUND;
+    for (const RootMove* root_move = root_begin; root_move != root_end; ++root_move) {
+        make_move(pos, info.undo, root_move->move);
+        const int score = -evaluate_pos(pos);
+        take_move(pos, info.undo);
+        if (score > best_score) {
+            best_score = score;
+            best_move = root_move->move;
+        }
+    }
+    return best_move;
+}
+
+// Sends bestmove, with a move to ponder on
+static void report_best_move(Board& pos, const HashTable& table, SearchInfo& info,
+                             Move best_move) {
+    // The bestmove of a ponder search may only be sent after "ponderhit" or "stop"
+    while (info.pondering.load(std::memory_order_relaxed) &&
+           !info.stop_requested.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (info.print_info) {
+        // Expected reply for the GUI to ponder on, from the TT if a cutoff cut the PV short
+        Move ponder_move = (info.PV_array.length > 1) ? info.PV_array.moves[1] : NO_MOVE;
+        if (ponder_move == NO_MOVE && best_move != NO_MOVE &&
+            make_move(pos, info.undo, best_move)) {
+            ponder_move = probe_PV_move(pos, table);
+            if (ponder_move != NO_MOVE && !move_exists(pos, info.undo, ponder_move)) {
+                ponder_move = NO_MOVE;
+            }
+            take_move(pos, info.undo);
+        }
+
+        if (info.on_bestmove) {
+            info.on_bestmove(best_move, ponder_move, info.callback_data);
+        } else {
+            std::string line = "bestmove " + print_move(best_move);
+            if (ponder_move != NO_MOVE) {
+                line += " ponder " + print_move(ponder_move);
+            }
+            send_line(line);
+        }
+    }
+}
+
+// Adds a move to go searchmoves, unless it is there already or the list is full (the input may
+// repeat moves any number of times)
+void add_searchmove(SearchLimits& limits, Move move) {
+    MoveList& searchmoves = limits.searchmoves;
+    ScoredMove* searchmoves_end = searchmoves.moves + searchmoves.length;
+    if (searchmoves.length == MAX_PSEUDO_MOVES ||
+        std::find_if(searchmoves.moves, searchmoves_end, [move](const ScoredMove& m) {
+            return m.move == move;
+        }) != searchmoves_end) {
+        return;
+    }
+    searchmoves.moves[searchmoves.length++] = {move, 0};
+}
+
+// Search limits and time management for a search of pos, from the go parameters
+// Leaves info.pondering alone: that is set before the search thread starts, so that a ponderhit
+// cannot get in before it
+void set_search_limits(const Board& pos, SearchInfo& info, const SearchLimits& limits) {
+    int time = (pos.side == WHITE) ? limits.wtime : limits.btime;
+    int inc = std::max((pos.side == WHITE) ? limits.winc : limits.binc, 0);
+
+    info.timeset = false;
+    info.nodesset = false;
+    info.ponder_search = limits.ponder;
+    info.stop_on_ponderhit = false;
+    info.searchmoves = limits.searchmoves;
+    info.movestogo = std::max(limits.movestogo, 0);
+
+    info.start_time = get_time_ms();
+    info.depth = (limits.depth == -1) ? MAX_DEPTH : limits.depth;
+    info.soft_time = 0;
+
+    // Time Management
+    if (limits.movetime != -1) {
+        // No time management, directly use available time (- buffer)
+        info.timeset = true;
+        int buffered_time = std::max(limits.movetime - limits.move_overhead, limits.move_overhead);
+        info.hard_stop_time = info.soft_stop_time = info.start_time + buffered_time;
+    } else if (time != -1) {
+        info.timeset = true;
+
+        // Soft limit based on current ply (phase) or the moves left to the next control
+        TimeLimits time_limits =
+            allocate_time_limits(pos.his_ply, time, inc, info.movestogo, limits.move_overhead);
+        // Ponder hits save time, so each move can afford a little more
+        if (limits.ponder_enabled) {
+            time_limits.soft =
+                std::max(time_limits.soft, std::min(time_limits.soft + time_limits.soft / 4,
+                                                    time_limits.hard - limits.move_overhead));
+        }
+        info.hard_stop_time = info.start_time + time_limits.hard;
+        info.soft_stop_time = info.start_time + time_limits.soft;
+        info.soft_time = time_limits.soft;  // Rescaled by the search
+    }
+
+    if (limits.nodes != -1) {
+        info.nodesset = true;
+        info.nodes_limit = limits.nodes;
+    }
 }
 
 /*
         Main search components
 */
 
+// Search the root to the given depth. From ASP_WIN_DEPTH on, the window starts narrow around the
+// score of the last iteration and widens on the failing side until the score falls inside
+// Aspiration windows algorithm adapted from Ethereal by Andrew Grant
+static int aspiration_search(Board& pos, HashTable& table, SearchInfo& info, int depth, int guess,
+                             PVLine* pv) {
+    // Do a full-window search for the first few depths as they are unstable
+    if (depth < ASP_WIN_DEPTH) {
+        return negamax_alphabeta(pos, table, info, -INF_BOUND, INF_BOUND, depth, pv, true, true);
+    }
+
+    int delta = ASP_WIN_SIZE;
+    int alpha = std::max(-INF_BOUND, guess - delta);
+    int beta = std::min(guess + delta, INF_BOUND);
+
+    while (true) {
+        int score = negamax_alphabeta(pos, table, info, alpha, beta, depth, pv, true, true);
+
+        // Stop researches when out of time
+        if (info.stopped) {
+            return score;
+        }
+
+        // Re-search with a wider window on the side that fails
+        if (score <= alpha) {
+            // Slide the window down
+            beta = (alpha + beta) / 2;
+            alpha = std::max(-INF_BOUND, alpha - delta);
+        } else if (score >= beta) {
+            // Increase beta and not touch alpha
+            beta = std::min(beta + delta, INF_BOUND);
+        }
+        // Search falls within expected bounds
+        else {
+            return score;
+        }
+
+        delta = delta + delta / 2;  // Expand the search window
+    }
+}
+
 // Quiescence search
 static inline int quiescence(Board& pos, HashTable& table, SearchInfo& info, int alpha, int beta,
                              PVLine* line) {
     check_up(info, false);  // Check if time is up
 
-    int flag = check_draw(pos, true);
+    int flag = check_draw(pos, info.undo, true);
     if (flag != -1) {
         return flag;
     }
@@ -172,7 +386,7 @@ static inline int quiescence(Board& pos, HashTable& table, SearchInfo& info, int
     int stand_pat = evaluate_pos(pos);
     int score = -INF_BOUND;
     int best_score = stand_pat;
-    int best_move = NO_MOVE;
+    Move best_move = NO_MOVE;
 
     if (stand_pat >= alpha) {
         alpha = stand_pat;
@@ -185,10 +399,16 @@ static inline int quiescence(Board& pos, HashTable& table, SearchInfo& info, int
     // Transposition table cutoffs
     // Probe before considering cutoff if it is not root
     // Loses elo if ordered before stand-pat
-    int hash_move = NO_MOVE;
+    Move hash_move = NO_MOVE;
     int hash_score = -INF_BOUND;
     int hash_depth = -1;
-    if (probe_hash_entry(pos, table, hash_move, hash_score, alpha, beta, hash_depth, 0)) {
+    bool tt_cut = probe_hash_entry(pos, table, hash_move, hash_score, alpha, beta, hash_depth, 0);
+    STAT_INC(info.stats, tt_probes);
+    if (hash_depth >= 0) {
+        STAT_INC(info.stats, tt_hits);
+    }
+    if (tt_cut) {
+        STAT_INC(info.stats, tt_cutoffs);
         table.cut++;
         return hash_score;
     }
@@ -198,6 +418,7 @@ static inline int quiescence(Board& pos, HashTable& table, SearchInfo& info, int
     */
     constexpr uint16_t big_delta = 936;  // Queen eg value
     if (stand_pat + big_delta < alpha) {
+        STAT_INC(info.stats, delta);
         return alpha;  // We are dead lost, no point searching for improvements
     }
 
@@ -206,21 +427,22 @@ static inline int quiescence(Board& pos, HashTable& table, SearchInfo& info, int
 
     uint16_t legal = 0;
 
-    sort_moves(pos, list, hash_move);
+    sort_moves(pos, info.heur, list, hash_move);
 
     for (int move_num = 0; move_num < (int)list.length; ++move_num) {
-        int curr_move = list.moves[move_num].move;
+        Move curr_move = list.moves[move_num].move;
 
         // Check if it's a legal move
-        if (!make_move(pos, curr_move)) {
+        if (!make_move(pos, info.undo, curr_move)) {
             continue;
         }
         info.nodes++;
+        STAT_INC(info.stats, qsearch_nodes);
         legal++;
 
         score = -quiescence(pos, table, info, -beta, -alpha, &candidate_PV);
 
-        take_move(pos);
+        take_move(pos, info.undo);
 
         if (info.stopped) {
             return 0;
@@ -236,13 +458,15 @@ static inline int quiescence(Board& pos, HashTable& table, SearchInfo& info, int
                 // Build new PV: current move + child PV
                 line->length = 1 + candidate_PV.length;
                 line->moves[0] = curr_move;
-                std::memcpy(line->moves + 1, candidate_PV.moves, sizeof(int) * candidate_PV.length);
+                std::memcpy(line->moves + 1, candidate_PV.moves, sizeof(Move) * candidate_PV.length);
 
                 if (score >= beta) {
                     if (legal == 1) {
                         info.fhf++;
+                        STAT_INC_AT(info.stats, first_move_cutoffs, 0);
                     }
                     info.fh++;
+                    STAT_INC_AT(info.stats, cutoffs, 0);
                     break;
                 }
             }
@@ -275,8 +499,7 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
     }
 
     uint8_t US = pos.side;
-    uint8_t THEM = US ^ 1;
-    bool in_check = is_square_attacked(pos, pos.king_sq[US], THEM);
+    bool in_check = pos.checkers != 0ULL;
 
     // Drop to qsearch at depth 0 or lower
     if (depth <= 0 && !in_check) {
@@ -288,10 +511,18 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
     // Check draw
     if (!is_root) {
         // Check draw
-        int flag = check_draw(pos, false);
+        int flag = check_draw(pos, info.undo, false);
         if (flag != -1) {
             return flag;
         }
+
+        // The side to move can force at least a draw by repeating
+        if (alpha < 0 && upcoming_repetition(pos, info.undo)) {
+            alpha = 0;
+            if (alpha >= beta) {
+                return alpha;
+            }
+        }
     }
 
     // Max depth reached
@@ -317,12 +548,17 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
 
     // Transposition table cutoffs
     // Probe before considering cutoff if it is not root
-    int hash_move = NO_MOVE;
+    Move hash_move = NO_MOVE;
     int hash_score = -INF_BOUND;
     int hash_depth = -1;
     bool tt_hit =
         probe_hash_entry(pos, table, hash_move, hash_score, alpha, beta, hash_depth, depth);
+    STAT_INC(info.stats, tt_probes);
+    if (hash_depth >= 0) {
+        STAT_INC(info.stats, tt_hits);
+    }
     if (tt_hit && !is_root) {
+        STAT_INC(info.stats, tt_cutoffs);
         table.cut++;
         return hash_score;
     }
@@ -345,6 +581,7 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
 
         int RFP_margin = beta + 80 * depth;
         if (depth <= 4 && static_eval >= RFP_margin) {
+            STAT_INC(info.stats, rfp);
             return static_eval;
         }
 
@@ -358,11 +595,11 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
             uint8_t big_pieces =
                 count_bits(pos.occupancies[US] ^ pos.bitboards[(US == WHITE) ? wP : bP]);
             if (big_pieces > 1) {
-                make_null_move(pos);
+                make_null_move(pos, info.undo);
                 uint8_t R = 3 + depth / 3;  // Reduction based on depth
                 int null_score = -negamax_alphabeta(pos, table, info, -beta, -beta + 1, depth - R,
                                                     &candidate_PV, false, false);
-                take_null_move(pos);
+                take_null_move(pos, info.undo);
 
                 if (info.stopped) {
                     return 0;
@@ -370,6 +607,7 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
 
                 // change these to null_score
                 if (null_score >= beta && abs(null_score) < MATE_SCORE) {
+                    STAT_INC(info.stats, nmp);
                     return null_score;
                 }
             }
@@ -391,26 +629,32 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
     */
 
     MoveList list;
-    generate_moves(pos, list, false);
+    if (is_root) {
+        // The root searches its own list, from the MultiPV line being searched on
+        for (int i = info.pv_index; i < (int)info.root_moves.length; ++i) {
+            list.moves[list.length++] = {info.root_moves.moves[i].move, 0};
+        }
+    } else {
+        generate_moves(pos, list, false);
+        sort_moves(pos, info.heur, list, hash_move);
+    }
 
     int legal = 0;
     int old_alpha = alpha;
-    int best_move = NO_MOVE;
+    Move best_move = NO_MOVE;
     int best_score = -INF_BOUND;
 
     // Futility pruning variable
     int futility_margin = 300 * depth;  // Scale margin with depth
 
-    sort_moves(pos, list, hash_move);
-
     for (int move_num = 0; move_num < (int)list.length; ++move_num) {
         init_PVLine(&candidate_PV);
         int score = -INF_BOUND;
-        int curr_move = list.moves[move_num].move;
+        Move curr_move = list.moves[move_num].move;
 
-        bool is_killer =
-            curr_move == pos.killer_moves[0][pos.ply] || curr_move == pos.killer_moves[1][pos.ply];
-        bool is_capture = (bool)get_move_captured(curr_move);
+        bool is_killer = curr_move == info.heur.killer_moves[0][pos.ply] ||
+                         curr_move == info.heur.killer_moves[1][pos.ply];
+        bool is_capture = (bool)get_move_capture(curr_move);
         bool is_promotion = (bool)get_move_promoted(curr_move);
         bool is_quiet = !is_capture && !is_promotion;
         bool is_mate = abs(best_score) >= MATE_SCORE;
@@ -425,6 +669,7 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
             uint8_t LMP_offset = 4;
             uint8_t LMP_multiplier = 3;
             if (move_num >= LMP_offset + LMP_multiplier * depth * depth) {
+                STAT_INC(info.stats, lmp);
                 continue;
             }
 
@@ -435,6 +680,7 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
             if (depth <= 3 && move_num >= 4) {
                 // Discard moves with no potential to raise alpha
                 if (static_eval + futility_margin <= alpha) {
+                    STAT_INC(info.stats, futility);
                     continue;
                 }
             }
@@ -442,11 +688,13 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
 
         // Check if it's a legal move
         // The move will be made for the rest of the code if it is
-        if (!make_move(pos, curr_move)) {
+        if (!make_move(pos, info.undo, curr_move)) {
             continue;
         }
+        uint64_t nodes_before = info.nodes;
         legal++;
         info.nodes++;
+        STAT_INC(info.stats, main_nodes);
 
         /*
             Late Move Reductions
@@ -468,9 +716,11 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
             // Search at reduced depth with null window
             score = -negamax_alphabeta(pos, table, info, -alpha - 1, -alpha, reduced_depth,
                                        &candidate_PV, true, false);
+            STAT_INC(info.stats, lmr_searches);
 
             // Re-search at full depth still with null window
             if (score > alpha) {
+                STAT_INC(info.stats, lmr_researches);
                 score = -negamax_alphabeta(pos, table, info, -alpha - 1, -alpha, depth - 1,
                                            &candidate_PV, true, false);
             }
@@ -490,12 +740,31 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
                                        &candidate_PV, true, true);
         }
 
-        take_move(pos);
+        take_move(pos, info.undo);
+
+        RootMove* root_move = is_root ? &info.root_moves.moves[info.pv_index + move_num] : nullptr;
+        if (is_root) {
+            root_move->nodes += info.nodes - nodes_before;
+        }
 
         if (info.stopped) {
             return 0;
         }
 
+        // A root move that fails low only has an upper bound, so it is scored as unsearched
+        if (is_root) {
+            if (legal == 1 || score > alpha) {
+                root_move->score = score;
+                root_move->pv.score = score;
+                root_move->pv.length = 1 + candidate_PV.length;
+                root_move->pv.moves[0] = curr_move;
+                std::memcpy(root_move->pv.moves + 1, candidate_PV.moves,
+                            sizeof(Move) * candidate_PV.length);
+            } else {
+                root_move->score = -INF_BOUND;
+            }
+        }
+
         // Update best_score and best_move
         if (score > best_score) {
             best_score = score;
@@ -505,16 +774,18 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
                 if (score >= beta) {
                     if (legal == 1) {
                         info.fhf++;
+                        STAT_INC_AT(info.stats, first_move_cutoffs, depth);
                     }
                     info.fh++;
+                    STAT_INC_AT(info.stats, cutoffs, depth);
 
                     // If the move that caused the beta cutoff is quiet we have a killer move
                     if (!is_capture) {
-                        pos.killer_moves[1][pos.ply] = pos.killer_moves[0][pos.ply];
-                        pos.killer_moves[0][pos.ply] = curr_move;
+                        info.heur.killer_moves[1][pos.ply] = info.heur.killer_moves[0][pos.ply];
+                        info.heur.killer_moves[0][pos.ply] = curr_move;
 
-                        pos.history_moves[get_move_piece(best_move)][get_move_target(best_move)] +=
-                        depth * depth;
+                        info.heur.history_moves[get_move_piece(pos, best_move)]
+                                               [get_move_target(best_move)] += depth * depth;
                     }
 
                     break;  // Fail-high
@@ -527,12 +798,19 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
                     line->score = score;
                     line->length = 1 + candidate_PV.length;
                     line->moves[0] = curr_move;
-                    std::memcpy(line->moves + 1, candidate_PV.moves, sizeof(int) * candidate_PV.length);
+                    std::memcpy(line->moves + 1, candidate_PV.moves, sizeof(Move) * candidate_PV.length);
                 }
             }
         }
     }
 
+    // Best first, for the aspiration re-searches and the next MultiPV line
+    if (is_root) {
+        std::stable_sort(info.root_moves.moves + info.pv_index,
+                         info.root_moves.moves + info.root_moves.length,
+                         [](const RootMove& a, const RootMove& b) { return a.score > b.score; });
+    }
+
     if (legal == 0) {
         if (in_check) {
             // Checkmate
@@ -544,6 +822,7 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
     }
 
     // Store move and score to TT
+    // (not for the later MultiPV lines at the root, which leave out the best moves)
     uint8_t hash_flag = HFNONE;
     if (best_score >= beta) {
         hash_flag = HFBETA;
@@ -552,7 +831,9 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
     } else {
         hash_flag = HFALPHA;
     }
-    store_hash_entry(pos, table, best_move, best_score, hash_flag, depth);
+    if (!is_root || info.pv_index == 0) {
+        store_hash_entry(pos, table, best_move, best_score, hash_flag, depth);
+    }
 
     // Fail-low
     return best_score;
@@ -563,31 +844,101 @@ static inline int negamax_alphabeta(Board& pos, HashTable& table, SearchInfo& in
 */
 
 // Check if the time is up
+// Reading the clock costs more than searching a node, so during search (hard limit) it is only
+// read every few hundred nodes: often enough to land about every half millisecond at the speed
+// measured so far
 static inline void check_up(SearchInfo& info, bool soft_limit) {
-    // Check if time is up
-    uint64_t time_limit = info.hard_stop_time;
-    uint64_t nodes_limit = info.nodes_limit;
-    bool& stopper = info.stopped;
-    if (soft_limit) {
-        time_limit = info.soft_stop_time;
-        stopper = info.soft_stopped;
+    bool* stopper = soft_limit ? &info.soft_stopped : &info.stopped;
+
+    if (info.stop_requested.load(std::memory_order_relaxed)) {
+        info.stopped = info.soft_stopped = true;
+        return;
     }
 
-    if (info.timeset && (get_time_ms() > time_limit)) {
-        stopper = true;
+    // A ponder search has no limits until the ponderhit turns it into a normal timed search. The
+    // pondering counts towards the soft limit, so the work done carries over, while the hard limit
+    // starts from the ponderhit, when our clock starts running
+    if (info.ponder_search) {
+        if (info.pondering.load(std::memory_order_relaxed)) {
+            return;
+        }
+        info.ponder_search = false;
+        info.hard_stop_time += get_time_ms() - info.start_time;
+        if (info.stop_on_ponderhit) {
+            info.stopped = info.soft_stopped = true;
+            return;
+        }
     }
+
     // Check if nodes limit is reached
-    else if (info.nodesset && info.nodes > nodes_limit) {
-        stopper = true;
+    if (info.nodesset && info.nodes > info.nodes_limit) {
+        *stopper = true;
+        return;
+    }
+
+    if (!info.timeset || (!soft_limit && info.nodes < info.next_time_check)) {
+        return;
+    }
+
+    uint64_t now = get_time_ms();
+    if (now > (soft_limit ? info.soft_stop_time : info.hard_stop_time)) {
+        *stopper = true;
+    }
+
+    if (!soft_limit) {
+        constexpr uint64_t MIN_CHECK_INTERVAL = 64;
+        constexpr uint64_t MAX_CHECK_INTERVAL = 16384;
+        uint64_t nps = info.nodes * 1000 / std::max(now - info.start_time, (uint64_t)1);
+        info.next_time_check =
+            info.nodes + std::clamp(nps / 2000, MIN_CHECK_INTERVAL, MAX_CHECK_INTERVAL);
     }
 }
 
-// Check if there's a two-fold repetition (linear search)
-static inline bool check_repetition(const Board& pos) {
-    const int start = std::max(pos.his_ply - pos.fifty_move, 0);
-    const int end = std::min(pos.his_ply - 1, MAX_GAME_MOVES - 1);
-    for (int i = start; i <= end; ++i) {
-        if (pos.hash_key == pos.move_history[i].hash_key) {
+// Check if there's a two-fold repetition
+// Only positions with the same side to move (even distance), at least 4 plies back and within
+// the fifty-move window can match
+static inline bool check_repetition(const Board& pos, const UndoStack& undo) {
+    const int end = std::min<int>(pos.fifty_move, pos.his_ply);
+    for (int i = 4; i <= end; i += 2) {
+        if (pos.hash_key == history_key(undo, pos.his_ply - i)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Check if the side to move has a move that repeats a position of the current search line
+// The key difference to a position an odd number of plies back is looked up in the cuckoo
+// tables of reversible moves; a hit whose path is clear is a move back to that position
+static inline bool upcoming_repetition(const Board& pos, const UndoStack& undo) {
+    const int end = std::min<int>(pos.fifty_move, pos.his_ply);
+    if (end < 3 || undo.move_history[pos.his_ply - 1].move == NO_MOVE) {
+        return false;
+    }
+
+    for (int i = 3; i <= end; i += 2) {
+        // Positions either side of a null move (or unknown history) aren't linked by real moves
+        if (undo.move_history[pos.his_ply - i].move == NO_MOVE ||
+            undo.move_history[pos.his_ply - i + 1].move == NO_MOVE) {
+            return false;
+        }
+
+        uint64_t move_key = pos.hash_key ^ history_key(undo, pos.his_ply - i);
+        int index = cuckoo_h1(move_key);
+        if (cuckoo_keys[index] != move_key) {
+            index = cuckoo_h2(move_key);
+            if (cuckoo_keys[index] != move_key) {
+                continue;
+            }
+        }
+
+        Move move = cuckoo_moves[index];
+        if (between_masks[get_move_source(move)][get_move_target(move)] & pos.occupancies[BOTH]) {
+            continue;  // Path is blocked
+        }
+
+        // Only cycles within the search count. Repeating a pre-root position once is no draw
+        if (pos.ply > i) {
             return true;
         }
     }
@@ -596,13 +947,13 @@ static inline bool check_repetition(const Board& pos) {
 
 // Returns 0 if there is a draw, unless there is a mate at the end of 50-move rule
 // Otherwise, returns -1
-static inline int check_draw(const Board& pos, bool qsearch) {
-    if (check_repetition(pos) && (qsearch || pos.ply)) {
+static inline int check_draw(const Board& pos, const UndoStack& undo, bool qsearch) {
+    if (check_repetition(pos, undo) && (qsearch || pos.ply)) {
         return 0;
     }
     if (pos.fifty_move >= 100) {
         // Make sure there isn't a checkmate on or before the 100th half-move
-        if (is_square_attacked(pos, pos.king_sq[pos.side], pos.side ^ 1)) {
+        if (pos.checkers) {
             MoveList list;
             generate_moves(pos, list, false);
             if (list.length == 0) {
@@ -621,30 +972,34 @@ static inline int check_draw(const Board& pos, bool qsearch) {
 static inline void clear_search_vars(Board& pos, HashTable& table, SearchInfo& info) {
     for (int pce = 0; pce < 13; ++pce) {
         for (int sq = 0; sq < 64; ++sq) {
-            pos.history_moves[pce][sq] = 0;
+            info.heur.history_moves[pce][sq] = 0;
         }
     }
     for (int id = 0; id < 2; ++id) {
         for (int depth = 0; depth < MAX_DEPTH; ++depth) {
-            pos.killer_moves[id][depth] = NO_MOVE;
+            info.heur.killer_moves[id][depth] = NO_MOVE;
         }
     }
 
     // Clear PV table
+    info.PV_array.length = 0;
+    info.PV_array.score = -INF_BOUND;
     for (int i = 0; i < MAX_DEPTH; ++i) {
-        pos.PV_array.moves[i] = 0;  // NO_MOVE
+        info.PV_array.moves[i] = 0;  // NO_MOVE
     }
 
     table.overwrite = 0;
     table.hit = 0;
     table.cut = 0;
-    table.table_age++;
+    age_hash_table(table);
     pos.ply = 0;
 
     info.seldepth = 0;
     info.soft_stopped = false;
     info.stopped = false;
     info.nodes = 0;
+    info.next_time_check = 0;
+    clear_search_stats(info.stats);
     info.fh = 0.0;
     info.fhf = 0.0;
 }
@@ -656,30 +1011,84 @@ void init_searchinfo(SearchInfo& info) {
     info.start_time = 0;
     info.hard_stop_time = 0;
     info.soft_stop_time = 0;
+    info.soft_time = 0;
     info.depth = 0;
     info.seldepth = 0;
     info.nodes = 0;
     info.nodes_limit = 0;
+    info.next_time_check = 0;
 
     info.movestogo = 0;
+    info.multipv = 1;
+    info.pv_index = 0;
     info.quit = false;
     info.soft_stopped = false;
     info.stopped = false;
+    info.print_info = true;
+
+    info.stop_requested = false;
+    info.pondering = false;
+    info.ponder_search = false;
+    info.stop_on_ponderhit = false;
+
+    info.on_report = nullptr;
+    info.on_bestmove = nullptr;
+    info.callback_data = nullptr;
 
     info.fh = 0.0f;
     info.fhf = 0.0f;
 }
 
-void init_LMR_table() {
+void init_search_limits(SearchLimits& limits) {
+    limits.wtime = limits.btime = -1;
+    limits.winc = limits.binc = -1;
+    limits.movestogo = -1;
+    limits.movetime = -1;
+    limits.depth = -1;
+    limits.nodes = -1;
+    limits.ponder = false;
+    limits.ponder_enabled = false;
+    limits.move_overhead = 75;
+    limits.searchmoves.length = 0;
+}
+
+/*
+        LMR table, generated at compile time
+*/
+
+// Natural log usable in constant expressions (std::log is not constexpr)
+static constexpr double constexpr_log(double x) {
+    // x = m * 2^e with m in [1, 2), then ln(m) = 2 * atanh((m - 1) / (m + 1))
+    int exponent = 0;
+    while (x >= 2.0) {
+        x /= 2.0;
+        ++exponent;
+    }
+    double z = (x - 1.0) / (x + 1.0);
+    double term = z;
+    double sum = 0.0;
+    for (int k = 1; k < 40; k += 2) {
+        sum += term / k;
+        term *= z * z;
+    }
+    return 2.0 * sum + exponent * 0.69314718055994530942;
+}
+
+static constexpr LMRTable init_LMR_table() {
+    LMRTable table = {};
     for (int depth = 3; depth < MAX_DEPTH; ++depth) {
         for (int move_num = 4; move_num < MAX_PSEUDO_MOVES; ++move_num) {
+            double log_product = constexpr_log(depth) * constexpr_log(move_num);
             // [0]: Noisy, [1]: Quiet
-            LMR_reduction_table[depth][move_num][0] = int(0.25 + log(depth) * log(move_num) / 3.25);
-            LMR_reduction_table[depth][move_num][1] = int(0.50 + log(depth) * log(move_num) / 3.00);
+            table[depth][move_num][0] = int(0.25 + log_product / 3.25);
+            table[depth][move_num][1] = int(0.50 + log_product / 3.00);
         }
     }
+    return table;
 }
 
+constexpr LMRTable LMR_reduction_table = init_LMR_table();
+
 /*
         PV management
 */
@@ -692,9 +1101,122 @@ static inline void init_PVLine(PVLine* line) {
     }
 }
 
-static inline void update_best_line(Board& pos, PVLine* pv) {
-    if (pv->score > pos.PV_array.score) {
-        pos.PV_array.length = pv->length;
-        memcpy(pos.PV_array.moves, pv->moves, sizeof(int) * pv->length);
+// Fill the root move list with the legal moves, or only those of go searchmoves, in the move
+// ordering of the first iteration
+static void init_root_moves(Board& pos, const HashTable& table, SearchInfo& info) {
+    MoveList list;
+    generate_moves(pos, list, false);
+    sort_moves(pos, info.heur, list, probe_PV_move(pos, table));
+
+    info.root_moves.length = 0;
+    for (int move_num = 0; move_num < (int)list.length; ++move_num) {
+        Move move = list.moves[move_num].move;
+        ScoredMove* searchmoves_end = info.searchmoves.moves + info.searchmoves.length;
+        bool in_searchmoves =
+            info.searchmoves.length == 0 ||
+            std::find_if(info.searchmoves.moves, searchmoves_end, [move](const ScoredMove& m) {
+                return m.move == move;
+            }) != searchmoves_end;
+        if (!in_searchmoves || !is_legal_move(pos, move)) {
+            continue;
+        }
+
+        RootMove& root_move = info.root_moves.moves[info.root_moves.length++];
+        root_move.move = move;
+        root_move.score = -INF_BOUND;
+        root_move.previous_score = -INF_BOUND;
+        root_move.nodes = 0;
+        init_PVLine(&root_move.pv);
+    }
+
+    // None of the searchmoves is legal here: search every move instead
+    if (info.root_moves.length == 0 && info.searchmoves.length > 0) {
+        info.searchmoves.length = 0;
+        init_root_moves(pos, table, info);
+    }
+}
+
+// Info for one PV, as a UCI info line or through the report callback; multipv is the line
+// number, or 0 to leave it out
+static void report_search_info(const SearchInfo& info, const HashTable& table, uint8_t depth,
+                               int multipv, const PVLine& pv, int score) {
+    SearchReport report;
+    report.depth = depth;
+    report.seldepth = info.seldepth;
+    report.multipv = multipv;
+    report.score = score;
+    report.time = get_time_ms() - info.start_time;  // in ms
+    report.nodes = info.nodes;
+    report.nps = static_cast<uint64_t>((info.nodes / (report.time + 0.01)) * 1000.0);  // Add 0.01ms to prevent division by zero error
+    report.hashfull = hashfull(table);
+    report.pv = &pv;
+
+    // Moves to mate if there's forced mate
+    report.mate = 0;
+    if (abs(score) >= MATE_SCORE && abs(score) < INF_BOUND) {
+        auto sgn = [](int v) { return v >= 0 ? 1 : -1; };
+        report.mate = (int8_t)(round((INF_BOUND - abs(score) - 1) / 2 + 1) * sgn(score));
+    }
+
+    if (info.on_report) {
+        info.on_report(report, info.callback_data);
+        return;
+    }
+
+    std::ostringstream line;
+    line << "info depth " << (int)depth << " seldepth " << (int)info.seldepth;
+    if (multipv > 0) {
+        line << " multipv " << multipv;
+    }
+    if (abs(score) >= MATE_SCORE) {
+        line << " score mate " << report.mate;  // mate 0: checkmated
+    } else {
+        line << " score cp " << score;
+    }
+    line << " nodes " << report.nodes << " nps " << report.nps << " hashfull " << report.hashfull
+         << " time " << report.time << " pv";
+
+    // Print PV
+    for (int i = 0; i < pv.length; ++i) {
+        line << " " << print_move(pv.moves[i]);
+    }
+    send_line(line.str());  // Flushed, so that it reaches the GUI depth by depth
+}
+
+// Writes a whole line to stdout. The search thread and the input thread (readyok) both write
+// while a search runs, so their lines go through here to keep from interleaving
+void send_line(const std::string& line) {
+    static std::mutex output_mutex;
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::cout << line << "\n" << std::flush;
+}
+
+// Continues a PV with the hash moves after it, up to depth moves
+static void extend_PV_line(Board& pos, UndoStack& undo, const HashTable& table, PVLine& pv,
+                           int depth) {
+    int made = 0;
+    while (made < pv.length && make_move(pos, undo, pv.moves[made])) {
+        made++;
+    }
+
+    if (made == pv.length) {
+        Move move = probe_PV_move(pos, table);
+        while (move != NO_MOVE && pv.length < depth && move_exists(pos, undo, move)) {
+            make_move(pos, undo, move);
+            made++;
+            pv.moves[pv.length++] = move;
+            move = probe_PV_move(pos, table);
+        }
+    }
+
+    while (made-- > 0) {
+        take_move(pos, undo);
+    }
+}
+
+static inline void update_best_line(SearchInfo& info, PVLine* pv) {
+    if (pv->score > info.PV_array.score) {
+        info.PV_array.length = pv->length;
+        memcpy(info.PV_array.moves, pv->moves, sizeof(Move) * pv->length);
     }
 }
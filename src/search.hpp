@@ -3,13 +3,64 @@
 #ifndef SEARCH_HPP
 #define SEARCH_HPP
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <string>
 
 #include "../chess/Board.hpp"
+#include "../chess/movegen.hpp"
 #include "StaticVector.hpp"
 #include "datatypes.hpp"
+#include "searchstats.hpp"
 #include "ttable.hpp"
 
+constexpr uint8_t MAX_MULTIPV = 64;  // Most PV lines the MultiPV option can ask for
+
+// A legal move at the root, with what the search has found out about it
+typedef struct {
+    Move move;
+    int score;           // Exact for the PV lines; -INF_BOUND when it failed low or is unsearched
+    int previous_score;  // Score in the last completed iteration
+    uint64_t nodes;      // Nodes searched under the move so far
+    PVLine pv;
+} RootMove;
+
+typedef StaticVector<RootMove, MAX_PSEUDO_MOVES> RootMoveList;
+
+// Limits of one search, as given by go (-1 where not given)
+typedef struct {
+    int wtime, btime;      // Clocks in ms
+    int winc, binc;        // Increments in ms
+    int movestogo;         // Moves to the next time control (0 or -1: sudden death)
+    int movetime;          // Fixed time in ms
+    int depth;
+    int64_t nodes;
+    bool ponder;           // Search without limits until the ponderhit
+    bool ponder_enabled;   // Ponder option: ponder hits pay back a little more time per move
+    int move_overhead;     // Kept off every time limit for communication delays
+    MoveList searchmoves;  // The only root moves to search (all if empty)
+} SearchLimits;
+
+// One finished iteration (one line of it with MultiPV), for the GUI
+typedef struct {
+    uint8_t depth;
+    uint8_t seldepth;
+    int multipv;  // Line number, 0 without MultiPV
+    int score;    // Centipawns, or mate scores (see mate)
+    int mate;     // Moves to mate, negative when getting mated; 0 if no mate was found (or if
+                  // checkmated already: score -INF_BOUND)
+    uint64_t nodes;
+    uint64_t nps;
+    uint64_t time;  // ms since the search started
+    int hashfull;   // Permill
+    const PVLine* pv;
+} SearchReport;
+
+// Search output goes to these if set, and to stdout as UCI text otherwise
+typedef void (*ReportCallback)(const SearchReport& report, void* data);
+typedef void (*BestMoveCallback)(Move best_move, Move ponder_move, void* data);
+
 typedef struct {
     bool timeset;   // go with time
     bool nodesset;  // go nodes <>
@@ -17,26 +68,54 @@ typedef struct {
     uint64_t start_time;
     uint64_t soft_stop_time;  // Soft time limit
     uint64_t hard_stop_time;  // Hard time limit
+    uint64_t soft_time;       // Allocated soft time in ms, before search feedback (0: fixed time)
 
     uint8_t depth;
     uint8_t seldepth;
     uint64_t nodes;
     uint64_t nodes_limit;
+    uint64_t next_time_check;  // Node count at which check_up next reads the clock
 
     uint16_t movestogo;
     bool quit;
     bool stopped;
     bool soft_stopped;
+    bool print_info;  // UCI info lines and bestmove (off for machine-readable bench output)
+
+    // Written by the UCI thread while the search runs
+    std::atomic<bool> stop_requested;  // "stop" or "quit"
+    std::atomic<bool> pondering;       // "go ponder", until "ponderhit"
+
+    bool ponder_search;      // Started as a ponder search and has not seen the ponderhit yet
+    bool stop_on_ponderhit;  // The soft limit passed while pondering
 
     float fh;   // beta cutoffs
     float fhf;  // legal moves
+
+    // Search-owned state, kept out of Board so that positions stay cheap to copy
+    UndoStack undo;       // Game history and current search line
+    MoveHeuristics heur;  // Killer and history moves
+    PVLine PV_array;      // Stores the final best PV after every depth
+    uint8_t multipv;      // Number of PV lines to search (MultiPV option)
+    uint8_t pv_index;     // MultiPV line being searched: the root skips the moves before it
+    MoveList searchmoves;      // go searchmoves: the only root moves to search (all if empty)
+    RootMoveList root_moves;   // The PV lines first, best first, after every iteration
+    SearchStats stats;    // Only counted when built with SEARCH_STATS
+
+    ReportCallback on_report;
+    BestMoveCallback on_bestmove;
+    void* callback_data;
 } SearchInfo;
 
-extern int LMR_reduction_table[MAX_DEPTH][MAX_PSEUDO_MOVES][2];  // [ply][move_num][is_quiet]
+typedef std::array<std::array<std::array<int, 2>, MAX_PSEUDO_MOVES>, MAX_DEPTH> LMRTable;
+extern const LMRTable LMR_reduction_table;  // [ply][move_num][is_quiet]
 
 // Functions
 void search_position(Board& pos, HashTable& table, SearchInfo& info);
 void init_searchinfo(SearchInfo& info);
-void init_LMR_table();
+void init_search_limits(SearchLimits& limits);
+void set_search_limits(const Board& pos, SearchInfo& info, const SearchLimits& limits);
+void add_searchmove(SearchLimits& limits, Move move);
+void send_line(const std::string& line);
 
 #endif  // SEARCH_HPP
\ No newline at end of file
@@ -0,0 +1,85 @@
+// searchstats.cpp
+
+#include "searchstats.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+void clear_search_stats(SearchStats& stats) { std::memset(&stats, 0, sizeof(SearchStats)); }
+
+void add_search_stats(SearchStats& total, const SearchStats& stats) {
+    // Every field is a uint64_t counter, so the structs can be summed as arrays
+    static_assert(sizeof(SearchStats) % sizeof(uint64_t) == 0);
+    const uint64_t* from = reinterpret_cast<const uint64_t*>(&stats);
+    uint64_t* to = reinterpret_cast<uint64_t*>(&total);
+    for (size_t i = 0; i < sizeof(SearchStats) / sizeof(uint64_t); ++i) {
+        to[i] += from[i];
+    }
+}
+
+static double ratio(uint64_t part, uint64_t whole) {
+    return whole ? (double)part / whole : 0.0;
+}
+
+std::string search_stats_info(const SearchStats& stats, int depth) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "info string stats nodes " << stats.main_nodes << " qnodes " << stats.qsearch_nodes
+        << " tt probes " << stats.tt_probes << " hits " << stats.tt_hits << " cutoffs "
+        << stats.tt_cutoffs << " pruned rfp " << stats.rfp << " nmp " << stats.nmp << " lmp "
+        << stats.lmp << " futility " << stats.futility << " delta " << stats.delta << " lmr "
+        << stats.lmr_searches << " research "
+        << 100 * ratio(stats.lmr_researches, stats.lmr_searches) << "%";
+
+    out << " fmc";
+    for (int d = 0; d <= std::min(depth, MAX_DEPTH - 1); ++d) {
+        if (stats.cutoffs[d]) {
+            out << " d" << d << " " << 100 * ratio(stats.first_move_cutoffs[d], stats.cutoffs[d])
+                << "%";
+        }
+    }
+
+    out << std::setprecision(2);
+    if (depth >= 2 && stats.iteration_nodes[depth - 1]) {
+        out << " ebf " << ratio(stats.iteration_nodes[depth], stats.iteration_nodes[depth - 1]);
+    }
+    return out.str();
+}
+
+std::string search_stats_json(const SearchStats& stats) {
+    std::ostringstream out;
+    out << "{\"main_nodes\": " << stats.main_nodes << ", \"qsearch_nodes\": "
+        << stats.qsearch_nodes << ", \"tt_probes\": " << stats.tt_probes
+        << ", \"tt_hits\": " << stats.tt_hits << ", \"tt_cutoffs\": " << stats.tt_cutoffs
+        << ", \"pruned\": {\"rfp\": " << stats.rfp << ", \"nmp\": " << stats.nmp
+        << ", \"lmp\": " << stats.lmp << ", \"futility\": " << stats.futility
+        << ", \"delta\": " << stats.delta << "}, \"lmr_searches\": " << stats.lmr_searches
+        << ", \"lmr_research_rate\": " << ratio(stats.lmr_researches, stats.lmr_searches);
+
+    // Per-depth arrays run up to the deepest depth with data
+    int last = 0;
+    for (int d = 0; d < MAX_DEPTH; ++d) {
+        if (stats.cutoffs[d]) {
+            last = d;
+        }
+    }
+    out << ", \"first_move_cutoff_rate\": [";
+    for (int d = 0; d <= last; ++d) {
+        out << (d ? ", " : "") << ratio(stats.first_move_cutoffs[d], stats.cutoffs[d]);
+    }
+
+    last = 0;
+    for (int d = 1; d <= MAX_DEPTH; ++d) {
+        if (stats.iteration_nodes[d]) {
+            last = d;
+        }
+    }
+    out << "], \"ebf\": [";
+    for (int d = 2; d <= last; ++d) {
+        out << (d > 2 ? ", " : "") << ratio(stats.iteration_nodes[d], stats.iteration_nodes[d - 1]);
+    }
+    out << "]}";
+    return out.str();
+}
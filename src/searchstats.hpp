@@ -0,0 +1,53 @@
+// searchstats.hpp
+
+#ifndef SEARCHSTATS_HPP
+#define SEARCHSTATS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "datatypes.hpp"
+
+// Search event counters, compiled in with "make STATS=1" (-DSEARCH_STATS).
+// Without it the STAT_* macros expand to nothing and the search pays nothing for them.
+typedef struct {
+    uint64_t main_nodes;
+    uint64_t qsearch_nodes;
+
+    uint64_t tt_probes;
+    uint64_t tt_hits;     // Key matched
+    uint64_t tt_cutoffs;  // Entry deep enough to return its score
+
+    // Nodes or moves cut by each pruning rule
+    uint64_t rfp;
+    uint64_t nmp;
+    uint64_t lmp;
+    uint64_t futility;
+    uint64_t delta;
+
+    uint64_t lmr_searches;
+    uint64_t lmr_researches;  // Reduced search beat alpha and was redone at full depth
+
+    // Indexed by remaining depth (qsearch is depth 0)
+    uint64_t cutoffs[MAX_DEPTH];
+    uint64_t first_move_cutoffs[MAX_DEPTH];
+
+    // Nodes spent on each iteration of iterative deepening, for the effective branching factor
+    uint64_t iteration_nodes[MAX_DEPTH + 1];
+} SearchStats;
+
+#ifdef SEARCH_STATS
+#define STAT_INC(stats, field) ((stats).field++)
+#define STAT_INC_AT(stats, field, index) ((stats).field[std::min((int)(index), MAX_DEPTH - 1)]++)
+#else
+#define STAT_INC(stats, field) ((void)0)
+#define STAT_INC_AT(stats, field, index) ((void)0)
+#endif
+
+void clear_search_stats(SearchStats& stats);
+void add_search_stats(SearchStats& total, const SearchStats& stats);
+std::string search_stats_info(const SearchStats& stats, int depth);  // One "info string" line
+std::string search_stats_json(const SearchStats& stats);
+
+#endif  // SEARCHSTATS_HPP
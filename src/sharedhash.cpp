@@ -0,0 +1,239 @@
+// sharedhash.cpp
+
+#include "sharedhash.hpp"
+
+#include "zobrist.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#endif
+
+constexpr uint64_t SHARED_HASH_MAGIC = 0x4452474E524F5345ULL;  // "DRGNROSE"
+constexpr size_t SHARED_HASH_HEADER_SIZE = 64;                  // Entries start after the header
+
+enum { SEGMENT_EMPTY, SEGMENT_READY, SEGMENT_REMOVED };
+
+// Start of a segment; only written under an exclusive flock
+typedef struct {
+    uint64_t magic;
+    uint32_t version;        // SHARED_HASH_VERSION
+    uint32_t entry_size;     // sizeof(HashEntry)
+    uint64_t key_signature;  // Processes must hash positions alike (see zobrist_signature)
+    uint64_t max_entries;
+    uint32_t state;  // SEGMENT_EMPTY until initialised, SEGMENT_REMOVED once unlinked
+    uint16_t table_age;  // Counts the searches of every process (see age_hash_table)
+} SharedHashHeader;
+
+static_assert(sizeof(SharedHashHeader) <= SHARED_HASH_HEADER_SIZE);
+
+struct SharedHashMapping {
+    void* base;
+    size_t size;
+    int fd;
+    std::string name;
+};
+
+// Fingerprint of the Zobrist keys
+static uint64_t zobrist_signature() {
+    uint64_t signature = side_key;
+    auto mix = [&signature](uint64_t key) {
+        signature = (signature ^ key) * 0x9E3779B97F4A7C15ULL;
+        signature ^= signature >> 29;
+    };
+    for (const auto& square_keys : piece_keys) {
+        for (uint64_t key : square_keys) {
+            mix(key);
+        }
+    }
+    for (uint64_t key : castle_keys) {
+        mix(key);
+    }
+    return signature;
+}
+
+#ifdef _WIN32
+
+bool attach_shared_hash_table(HashTable& table, const uint32_t MB, const std::string& name,
+                              std::string& error) {
+    (void)MB, (void)name;
+    free_hash_table(table);
+    error = "shared-memory hash tables are not supported on Windows";
+    return false;
+}
+
+void detach_shared_hash_table(HashTable& table) {
+    table.shared = nullptr;
+}
+
+#else
+
+static inline size_t segment_size(uint64_t max_entries) {
+    return SHARED_HASH_HEADER_SIZE + max_entries * sizeof(HashEntry);
+}
+
+// Why a segment cannot be used by this build, or an empty string if it can
+static std::string check_header(const SharedHashHeader& header, size_t size) {
+    if (header.magic != SHARED_HASH_MAGIC) {
+        return "not a Dragonrose hash table";
+    }
+    if (header.version != SHARED_HASH_VERSION || header.entry_size != sizeof(HashEntry)) {
+        return "made by a build with another table format (version " +
+               std::to_string(header.version) + ", this build " +
+               std::to_string(SHARED_HASH_VERSION) + ")";
+    }
+    if (header.key_signature != zobrist_signature()) {
+        return "made by a build with other hash keys";
+    }
+    if (size != segment_size(header.max_entries)) {
+        return "size does not match its header";
+    }
+    return "";
+}
+
+// (Re)builds the segment as an empty table; needs the exclusive flock
+static bool init_segment(int fd, const uint32_t MB, std::string& error) {
+    const uint64_t max_entries = static_cast<size_t>(0x100000) * MB / sizeof(HashEntry) - 2;
+    const size_t size = segment_size(max_entries);
+
+    // Truncating first zeroes whatever a previous table left
+    if (ftruncate(fd, 0) != 0 || ftruncate(fd, size) != 0) {
+        error = std::string("cannot size the segment: ") + std::strerror(errno);
+        return false;
+    }
+
+    void* base = mmap(nullptr, SHARED_HASH_HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        error = std::string("cannot map the segment: ") + std::strerror(errno);
+        return false;
+    }
+
+    SharedHashHeader* header = static_cast<SharedHashHeader*>(base);
+    header->magic = SHARED_HASH_MAGIC;
+    header->version = SHARED_HASH_VERSION;
+    header->entry_size = sizeof(HashEntry);
+    header->key_signature = zobrist_signature();
+    header->max_entries = max_entries;
+    header->table_age = 0;
+    header->state = SEGMENT_READY;
+    munmap(base, SHARED_HASH_HEADER_SIZE);
+    return true;
+}
+
+bool attach_shared_hash_table(HashTable& table, const uint32_t MB, const std::string& name,
+                              std::string& error) {
+    free_hash_table(table);
+
+    const std::string shm_name = name[0] == '/' ? name : "/" + name;
+
+    // Retry while another process initialises or removes the segment
+    for (int attempt = 0; attempt < 200; ++attempt) {
+        int fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0) {
+            error = std::string("cannot open the segment: ") + std::strerror(errno);
+            return false;
+        }
+
+        // Held while attached; only waits for a process initialising or removing the segment
+        if (flock(fd, LOCK_SH) != 0) {
+            error = std::string("cannot lock the segment: ") + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            error = std::string("cannot stat the segment: ") + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* base = MAP_FAILED;
+        uint32_t state = SEGMENT_EMPTY;
+        std::string problem = "empty";
+
+        if (size >= SHARED_HASH_HEADER_SIZE) {
+            base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (base == MAP_FAILED) {
+                error = std::string("cannot map the segment: ") + std::strerror(errno);
+                close(fd);
+                return false;
+            }
+            const SharedHashHeader& header = *static_cast<SharedHashHeader*>(base);
+            state = header.state;
+            problem = state == SEGMENT_READY ? check_header(header, size) : "not initialised";
+        }
+
+        if (state == SEGMENT_READY && problem.empty()) {
+            const SharedHashHeader& header = *static_cast<SharedHashHeader*>(base);
+            table.pTable = reinterpret_cast<HashEntry*>(static_cast<char*>(base) +
+                                                        SHARED_HASH_HEADER_SIZE);
+            table.shared = new SharedHashMapping{base, size, fd, shm_name};
+            table.max_entries = header.max_entries;
+            clear_hash_table(table);
+            table.shared_age = &static_cast<SharedHashHeader*>(base)->table_age;
+            table.table_age = std::atomic_ref<uint16_t>(*table.shared_age).load();
+            return true;
+        }
+
+        if (base != MAP_FAILED) {
+            munmap(base, size);
+        }
+        if (state == SEGMENT_REMOVED) {
+            close(fd);  // Unlinked meanwhile: the next shm_open makes a new one
+            continue;
+        }
+
+        // Empty, left half-made by a process that died, or from an incompatible build. It can
+        // be rebuilt if no other process is attached to it.
+        if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+            bool built = init_segment(fd, MB, error);
+            close(fd);
+            if (!built) {
+                return false;
+            }
+            continue;  // Attach like any other process
+        }
+        close(fd);
+
+        if (state == SEGMENT_READY) {
+            error = "segment " + shm_name + " is in use and " + problem;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    error = "segment " + shm_name + " did not become ready";
+    return false;
+}
+
+void detach_shared_hash_table(HashTable& table) {
+    SharedHashMapping* mapping = table.shared;
+
+    // The last process out removes the segment
+    if (flock(mapping->fd, LOCK_EX | LOCK_NB) == 0) {
+        static_cast<SharedHashHeader*>(mapping->base)->state = SEGMENT_REMOVED;
+        shm_unlink(mapping->name.c_str());
+    }
+
+    munmap(mapping->base, mapping->size);
+    close(mapping->fd);
+    delete mapping;
+
+    table.shared = nullptr;
+    table.shared_age = nullptr;
+    table.pTable = nullptr;
+    table.max_entries = 0;
+    table.num_entries = 0;
+}
+
+#endif
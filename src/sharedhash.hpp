@@ -0,0 +1,34 @@
+// sharedhash.hpp
+
+/*
+    Hash tables in a named POSIX shared-memory segment, so that engine processes on one host
+    search with the same table (entries are lockless, see HashEntry). The segment starts with a
+    header that identifies the build; processes of an incompatible build are turned away.
+
+    Every process attached to a segment holds a shared flock on it, which the kernel also drops
+    when a process dies. The last process to detach removes the segment, and one left behind by
+    processes that died is reused (or rebuilt) by the next process to attach.
+
+    The header also holds the table age, which every search of every process advances. Entries
+    of a search that another process started later count as old for replacement and hashfull.
+*/
+
+#ifndef SHAREDHASH_HPP
+#define SHAREDHASH_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "ttable.hpp"
+
+// Bump when HashEntry or the packing of HashData changes
+constexpr uint32_t SHARED_HASH_VERSION = 2;
+
+// Functions
+// A new segment gets MB megabytes; an existing one keeps its size. On failure the table is left
+// without entries and error says why
+bool attach_shared_hash_table(HashTable& table, const uint32_t MB, const std::string& name,
+                              std::string& error);
+void detach_shared_hash_table(HashTable& table);
+
+#endif  // SHAREDHASH_HPP
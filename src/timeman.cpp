@@ -2,6 +2,7 @@
 
 #include "timeman.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <iostream>
@@ -17,8 +18,15 @@ uint64_t get_time_ms() {
 }
 
 // Allocate time based on the current ply, which is used to determine the phase of the game
+// movestogo: moves left until the next time control of a repeating control (0 for sudden death)
 // Returns the time allocated in milliseconds
-int allocate_time(const Board& pos, int base_time, int inc) {
+int allocate_time(int ply, int base_time, int inc, int movestogo) {
+    // REPEATING CONTROL: the clock only has to last until the next control, so spread it evenly
+    // over the moves left (keeping a couple in reserve for the time trouble moves)
+    if (movestogo > 0) {
+        return base_time / (movestogo + MOVESTOGO_RESERVE) + inc * 3 / 4;
+    }
+
     int time = (base_time + inc * 3 / 4) * 95 / 100;
 
     // TIME TROUBLE CAES: Allocate time dynamically based on time left
@@ -42,8 +50,8 @@ int allocate_time(const Board& pos, int base_time, int inc) {
     const Phase stages[] = { {30, 12}, {80, 82} }; // Opening, Middlegame
 
     for (const auto& stage : stages) {
-        if (pos.his_ply <= stage.limit) {
-            int moves = (stage.limit + 10 - pos.his_ply) / 2;
+        if (ply <= stage.limit) {
+            int moves = (stage.limit + 10 - ply) / 2;
             return (time * stage.weight) / (100 * std::max(1, moves));
         }
     }
@@ -51,3 +59,42 @@ int allocate_time(const Board& pos, int base_time, int inc) {
     // ENDGAME PHASE: Flat divisor until time trouble
     return time / 40;
 }
+
+// Soft and hard limits for a clock of base_time ms, less the move overhead
+// Sudden death caps the hard limit at a tenth of the clock; with a repeating control the last
+// moves before it may use more of what is left, up to four times the allocation
+TimeLimits allocate_time_limits(int ply, int base_time, int inc, int movestogo, int overhead) {
+    int allocated = allocate_time(ply, base_time, inc, movestogo);
+    int hard = (movestogo > 0) ? std::min(base_time * 8 / 10, allocated * 4)
+                               : (base_time + inc * 3 / 4) / 10;
+    hard = std::max(hard - overhead, overhead);
+
+    // Prevent soft limit from exceeding hard limit, but keep it above 0: a soft limit of 0 turns off
+    // its scaling and the iteration time prediction, which matter most on a short clock
+    int soft = std::max(allocated - overhead, overhead / 10);
+    soft = std::min(soft, std::max(hard - overhead, hard / 2));
+    return {std::max(soft, 1), hard};
+}
+
+// Scale the soft time limit with feedback from the last iteration: a best move that keeps changing,
+// or that the search spent few of its nodes on (its rivals came close), gets more time; a stable
+// best move that took most of the nodes gets less
+// stability: number of iterations in a row that returned the same best move
+uint64_t scale_soft_time(uint64_t soft_time, int stability, uint64_t best_move_nodes,
+                         uint64_t total_nodes) {
+    constexpr double stability_scales[] = {2.2, 1.6, 1.4, 1.1, 1.0, 0.95, 0.9};
+    double stability_scale = stability_scales[std::min(stability, 6)];
+
+    // Neutral at a fraction of 0.7, about the median over the bench positions at depth 12
+    double best_move_fraction = (double)best_move_nodes / std::max(total_nodes, (uint64_t)1);
+    double node_scale = (1.5 - best_move_fraction) * 1.25;
+
+    return soft_time * stability_scale * node_scale;
+}
+
+// Predict how long the next iteration of iterative deepening takes, from the last one's time and
+// how much the node count grew from the iteration before it (the effective branching factor)
+uint64_t predict_iteration_time(uint64_t last_time, uint64_t last_nodes, uint64_t previous_nodes) {
+    double growth = previous_nodes ? (double)last_nodes / previous_nodes : 2.0;
+    return last_time * std::clamp(growth, 1.0, 4.0);
+}
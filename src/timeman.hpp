@@ -10,7 +10,22 @@ struct Phase {
     int weight; 
 };
 
+// Search time limits in milliseconds from the start of the search
+struct TimeLimits {
+    int soft;  // Don't start another iteration past this
+    int hard;  // Abort the search
+};
+
+constexpr int MOVESTOGO_RESERVE = 2;  // Moves kept in hand when spreading a repeating control
+
+// Search feedback only scales the soft limit from this depth on
+constexpr uint8_t SOFT_SCALE_DEPTH = 4;
+
 uint64_t get_time_ms();
-int allocate_time(const Board& pos, int base_time, int inc);
+int allocate_time(int ply, int base_time, int inc, int movestogo);
+TimeLimits allocate_time_limits(int ply, int base_time, int inc, int movestogo, int overhead);
+uint64_t scale_soft_time(uint64_t soft_time, int stability, uint64_t best_move_nodes,
+                         uint64_t total_nodes);
+uint64_t predict_iteration_time(uint64_t last_time, uint64_t last_nodes, uint64_t previous_nodes);
 
 #endif  // TIMEMAN_HPP
\ No newline at end of file
@@ -0,0 +1,245 @@
+// microbench.cpp
+
+// Times the engine's hot primitives in isolation over the bench positions.
+// Build with "make microbench", run as "./microbench [samples] [filter]".
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_RDTSC
+#endif
+
+#include "../chess/Board.hpp"
+#include "../chess/bench.hpp"
+#include "../chess/makemove.hpp"
+#include "../chess/movegen.hpp"
+#include "../eval/evaluate.hpp"
+#include "../ttable.hpp"
+
+constexpr int DEFAULT_SAMPLES = 15;
+constexpr double MIN_SAMPLE_NS = 20e6;  // Repeat a pass until one sample takes at least 20ms
+
+// Results are folded into here so the compiler cannot drop the work being timed
+static volatile uint64_t sink = 0;
+
+static inline uint64_t read_cycles() {
+#ifdef HAS_RDTSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// A primitive runs one pass over its inputs and returns the number of calls it made
+typedef struct {
+    std::string name;
+    std::function<uint64_t()> pass;
+} Primitive;
+
+typedef struct {
+    double ns;      // Per call
+    double cycles;  // Per call
+} Sample;
+
+static void run_primitive(const Primitive& primitive, int samples) {
+    // Warm up caches and branch predictors, doubling the pass count until a sample is long enough
+    uint64_t calls_per_pass = primitive.pass();
+    int passes = 1;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < passes; ++i) {
+            primitive.pass();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= MIN_SAMPLE_NS) {
+            break;
+        }
+        passes *= 2;
+    }
+
+    std::vector<Sample> results;
+    for (int s = 0; s < samples; ++s) {
+        uint64_t start_cycles = read_cycles();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < passes; ++i) {
+            primitive.pass();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        uint64_t cycles = read_cycles() - start_cycles;
+
+        double calls = (double)calls_per_pass * passes;
+        results.push_back({elapsed.count() / calls, cycles / calls});
+    }
+
+    std::sort(results.begin(), results.end(),
+              [](const Sample& a, const Sample& b) { return a.ns < b.ns; });
+    double mean = 0;
+    for (const Sample& sample : results) {
+        mean += sample.ns;
+    }
+    mean /= results.size();
+    double variance = 0;
+    for (const Sample& sample : results) {
+        variance += (sample.ns - mean) * (sample.ns - mean);
+    }
+    double stddev = std::sqrt(variance / results.size());
+    const Sample& median = results[results.size() / 2];
+
+    std::cout << std::left << std::setw(18) << primitive.name << std::right << std::setw(10)
+              << calls_per_pass << std::fixed << std::setprecision(2) << std::setw(10)
+              << median.ns << std::setw(10) << results.front().ns << std::setw(10) << mean
+              << std::setw(9) << 100 * stddev / mean << "%" << std::setw(10) << median.cycles
+              << "\n"
+              << std::flush;
+}
+
+int main(int argc, char* argv[]) {
+    int samples = (argc > 1) ? std::max(atoi(argv[1]), 1) : DEFAULT_SAMPLES;
+    std::string filter = (argc > 2) ? argv[2] : "";
+
+    // Inputs: the bench positions and every position one legal move away from them.
+    // The TT primitives use the positions two moves away, so the table sees many distinct keys.
+    auto undo = std::make_unique<UndoStack>();
+    std::vector<Board> positions;
+    std::vector<Board> leaves;
+    for (const std::string& fen : bench_positions) {
+        Board root;
+        parse_fen(root, fen);
+        reset_undo_stack(*undo);
+        positions.push_back(root);
+
+        MoveList moves;
+        generate_moves(root, moves, false);
+        for (int i = 0; i < (int)moves.length; ++i) {
+            if (!make_move(root, *undo, moves.moves[i].move)) {
+                continue;
+            }
+            positions.push_back(root);
+
+            MoveList replies;
+            generate_moves(root, replies, false);
+            for (int j = 0; j < (int)replies.length; ++j) {
+                if (make_move(root, *undo, replies.moves[j].move)) {
+                    leaves.push_back(root);
+                    take_move(root, *undo);
+                }
+            }
+            take_move(root, *undo);
+        }
+    }
+
+    std::vector<MoveList> move_lists(positions.size());
+    for (size_t p = 0; p < positions.size(); ++p) {
+        generate_moves(positions[p], move_lists[p], false);
+    }
+
+    HashTable table = {};
+    init_hash_table(table, BENCH_HASH);
+    for (Board& leaf : leaves) {
+        store_hash_entry(leaf, table, NO_MOVE, 0, HFEXACT, 1);
+    }
+
+    std::vector<Primitive> primitives = {
+        {"generate_moves",
+         [&]() {
+             for (const Board& pos : positions) {
+                 MoveList list;
+                 generate_moves(pos, list, false);
+                 sink = sink + list.length;
+             }
+             return (uint64_t)positions.size();
+         }},
+        {"generate_noisy",
+         [&]() {
+             for (const Board& pos : positions) {
+                 MoveList list;
+                 generate_moves(pos, list, true);
+                 sink = sink + list.length;
+             }
+             return (uint64_t)positions.size();
+         }},
+        {"is_legal_move",
+         [&]() {
+             uint64_t calls = 0;
+             for (size_t p = 0; p < positions.size(); ++p) {
+                 for (int i = 0; i < (int)move_lists[p].length; ++i) {
+                     sink = sink + is_legal_move(positions[p], move_lists[p].moves[i].move);
+                 }
+                 calls += move_lists[p].length;
+             }
+             return calls;
+         }},
+        {"make_take_move",
+         [&]() {
+             uint64_t calls = 0;
+             for (size_t p = 0; p < positions.size(); ++p) {
+                 Board& pos = positions[p];
+                 for (int i = 0; i < (int)move_lists[p].length; ++i) {
+                     if (make_move(pos, *undo, move_lists[p].moves[i].move)) {
+                         sink = sink + pos.hash_key;
+                         take_move(pos, *undo);
+                     }
+                 }
+                 calls += move_lists[p].length;
+             }
+             return calls;
+         }},
+        {"evaluate_pos",
+         [&]() {
+             for (const Board& pos : positions) {
+                 sink = sink + evaluate_pos(pos);
+             }
+             return (uint64_t)positions.size();
+         }},
+        {"probe_hash_entry",
+         [&]() {
+             for (Board& leaf : leaves) {
+                 Move move = NO_MOVE;
+                 int score = 0, entry_depth = 0;
+                 sink = sink + probe_hash_entry(leaf, table, move, score, -INF_BOUND, INF_BOUND,
+                                                entry_depth, 1);
+             }
+             return (uint64_t)leaves.size();
+         }},
+        {"store_hash_entry",
+         [&]() {
+             for (Board& leaf : leaves) {
+                 store_hash_entry(leaf, table, NO_MOVE, 0, HFEXACT, 1);
+             }
+             return (uint64_t)leaves.size();
+         }},
+    };
+
+    std::cout << positions.size() << " positions, " << leaves.size() << " TT keys, " << samples
+              << " samples per primitive"
+#ifndef HAS_RDTSC
+              << " (no rdtsc on this target: cycles read 0)"
+#endif
+              << "\n\n"
+              << std::left << std::setw(18) << "primitive" << std::right << std::setw(10)
+              << "calls" << std::setw(10) << "median" << std::setw(10) << "min" << std::setw(10)
+              << "mean" << std::setw(10) << "stddev" << std::setw(10) << "cycles"
+              << "\n"
+              << std::setw(18 + 10) << "" << std::setw(30) << "(ns per call)" << std::setw(20)
+              << "" << "\n";
+
+    for (const Primitive& primitive : primitives) {
+        if (primitive.name.find(filter) != std::string::npos) {
+            run_primitive(primitive, samples);
+        }
+    }
+
+    delete[] table.pTable;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+// tmsim.cpp
+
+// Time management simulator: replays the per-move thinking profiles of recorded games against a
+// time control, to compare allocation schemes offline.
+// Build with "make tmsim", run as "./tmsim <uci log> <control>... [engine name]".
+//
+// The log is the engine's UCI traffic (e.g. from cutechess-cli -debug; any prefix before the
+// commands is ignored, and with an engine name only lines containing it are read). Every
+// "go ... bestmove" becomes one profile: the time and node count at which each iteration finished.
+// Iterations the recorded search did not reach are extrapolated with the same growth estimate the
+// engine uses. Controls use cutechess notation in seconds: "moves/time+inc" or "time+inc".
+//
+// Not modelled: soft limit scaling by best-move stability and node share (the log does not say
+// how the nodes were split between root moves), and GUI latency.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../timeman.hpp"
+
+constexpr int DEFAULT_OVERHEAD = 75;  // UCI Move Overhead default
+
+typedef struct {
+    int ply;                          // Half-moves since the position's FEN
+    std::vector<uint64_t> times;      // ms at which each iteration finished
+    std::vector<uint64_t> nodes;      // Nodes searched by each iteration
+} Profile;
+
+typedef std::vector<Profile> Game;
+
+typedef struct {
+    int moves;  // Moves per control, 0 for sudden death
+    int time;   // ms per control
+    int inc;    // ms
+} TimeControl;
+
+static uint64_t value_after(const std::string& line, const std::string& key) {
+    size_t pos = line.find(" " + key + " ");
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    return std::strtoull(line.c_str() + pos + key.size() + 2, nullptr, 10);
+}
+
+static std::vector<Game> read_games(const std::string& path, const std::string& engine) {
+    std::vector<Game> games(1);
+    std::ifstream file(path);
+    std::string line;
+    Profile profile;
+    int ply = 0;
+    bool searching = false;
+    uint64_t last_nodes = 0;
+
+    while (std::getline(file, line)) {
+        if (!engine.empty() && line.find(engine) == std::string::npos) {
+            continue;
+        }
+        if (line.find("ucinewgame") != std::string::npos) {
+            if (!games.back().empty()) {
+                games.emplace_back();
+            }
+        } else if (line.find("position ") != std::string::npos) {
+            size_t moves = line.find(" moves ");
+            ply = 0;
+            if (moves != std::string::npos) {
+                std::istringstream iss(line.substr(moves + 7));
+                std::string move;
+                while (iss >> move) {
+                    ++ply;
+                }
+            }
+        } else if (line.find("go ") != std::string::npos ||
+                   (line.size() >= 2 && line.compare(line.size() - 2, 2, "go") == 0)) {
+            profile = {ply, {}, {}};
+            searching = true;
+            last_nodes = 0;
+        } else if (searching && line.find("info depth ") != std::string::npos) {
+            uint64_t nodes = value_after(line, "nodes");
+            profile.times.push_back(value_after(line, "time"));
+            profile.nodes.push_back(nodes - std::min(nodes, last_nodes));
+            last_nodes = nodes;
+        } else if (searching && line.find("bestmove") != std::string::npos) {
+            if (!profile.times.empty()) {
+                games.back().push_back(profile);
+            }
+            searching = false;
+        }
+    }
+    if (games.back().empty()) {
+        games.pop_back();
+    }
+    return games;
+}
+
+static bool parse_control(const std::string& text, TimeControl& control) {
+    size_t slash = text.find('/');
+    size_t plus = text.find('+');
+    std::string base = text.substr(slash == std::string::npos ? 0 : slash + 1,
+                                   plus == std::string::npos ? std::string::npos
+                                                             : plus - (slash + 1));
+    control.moves = (slash == std::string::npos) ? 0 : atoi(text.substr(0, slash).c_str());
+    control.time = (int)(atof(base.c_str()) * 1000);
+    control.inc = (plus == std::string::npos) ? 0 : (int)(atof(text.c_str() + plus + 1) * 1000);
+    return control.time > 0 && control.moves >= 0;
+}
+
+// Replay one search against its limits as search_position would stop it.
+// Returns the time used; depth is the last finished iteration (0-based), aborted if the hard limit
+// cut an iteration short.
+static uint64_t replay(const Profile& profile, TimeLimits limits, int& depth, bool& aborted) {
+    std::vector<uint64_t> times = profile.times;
+    std::vector<uint64_t> nodes = profile.nodes;
+    aborted = false;
+
+    for (size_t k = 0; k < MAX_DEPTH; ++k) {
+        // Extrapolate iterations the recorded search did not get to
+        if (k == times.size()) {
+            uint64_t last_time = times[k - 1] - (k >= 2 ? times[k - 2] : 0);
+            uint64_t previous_nodes = (k >= 2) ? nodes[k - 2] : 0;
+            uint64_t next_time = std::max<uint64_t>(
+                predict_iteration_time(last_time, nodes[k - 1], previous_nodes), 1);
+            times.push_back(times[k - 1] + next_time);
+            uint64_t growth = std::max<uint64_t>(next_time / std::max<uint64_t>(last_time, 1), 1);
+            nodes.push_back(nodes[k - 1] * growth);
+        }
+
+        if (times[k] > (uint64_t)limits.hard) {
+            depth = (int)k - 1;
+            aborted = true;
+            return limits.hard;
+        }
+        depth = (int)k;
+        if (times[k] > (uint64_t)limits.soft) {
+            return times[k];
+        }
+
+        uint64_t last_time = times[k] - (k >= 1 ? times[k - 1] : 0);
+        uint64_t predicted = predict_iteration_time(last_time, nodes[k], k >= 1 ? nodes[k - 1] : 0);
+        if (times[k] + predicted > (uint64_t)limits.hard) {
+            return times[k];
+        }
+    }
+    return times.back();
+}
+
+static void simulate(const std::vector<Game>& games, const TimeControl& control,
+                     const std::string& name, int overhead) {
+    int moves = 0, losses = 0, aborts = 0, controls_reached = 0;
+    uint64_t total_used = 0, total_depth = 0, left_at_control = 0;
+    int min_depth = MAX_DEPTH;
+    int64_t min_clock = INT64_MAX;
+
+    for (const Game& game : games) {
+        int64_t clock = control.time;
+        for (int i = 0; i < (int)game.size(); ++i) {
+            int movestogo = control.moves ? control.moves - i % control.moves : 0;
+            TimeLimits limits = allocate_time_limits(game[i].ply, (int)clock, control.inc,
+                                                     movestogo, overhead);
+            int depth = 0;
+            bool aborted = false;
+            uint64_t used = replay(game[i], limits, depth, aborted);
+
+            ++moves;
+            total_used += used;
+            total_depth += depth + 1;
+            min_depth = std::min(min_depth, depth + 1);
+            aborts += aborted;
+
+            clock -= used;
+            min_clock = std::min(min_clock, clock);
+            if (clock < 0) {
+                ++losses;
+                break;
+            }
+            clock += control.inc;
+            if (control.moves && (i + 1) % control.moves == 0) {
+                left_at_control += clock;
+                ++controls_reached;
+                clock += control.time;
+            }
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << name << ": " << games.size() << " games, "
+              << moves << " moves\n"
+              << "  time/move   " << total_used / 1000.0 / std::max(moves, 1) << "s\n"
+              << "  depth       " << (double)total_depth / std::max(moves, 1) << " avg, "
+              << min_depth << " min\n"
+              << "  hard aborts " << aborts << "\n"
+              << "  time losses " << losses << "\n"
+              << "  lowest clock " << min_clock / 1000.0 << "s\n";
+    if (controls_reached) {
+        std::cout << "  left at control " << left_at_control / 1000.0 / controls_reached
+                  << "s avg\n";
+    }
+    std::cout << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <uci log> <control>... [engine name]\n"
+                  << "  control: moves/time+inc or time+inc, in seconds (e.g. 40/120 or 60+0.6)\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<TimeControl> controls;
+    std::vector<std::string> names;
+    std::string engine;
+    for (int arg = 2; arg < argc; ++arg) {
+        TimeControl control;
+        if (parse_control(argv[arg], control)) {
+            controls.push_back(control);
+            names.push_back(argv[arg]);
+        } else {
+            engine = argv[arg];
+        }
+    }
+
+    std::vector<Game> games = read_games(argv[1], engine);
+    if (games.empty()) {
+        std::cerr << "No searches found in " << argv[1] << "\n";
+        return EXIT_FAILURE;
+    }
+
+    for (size_t c = 0; c < controls.size(); ++c) {
+        simulate(games, controls[c], names[c], DEFAULT_OVERHEAD);
+    }
+    return EXIT_SUCCESS;
+}
@@ -2,27 +2,66 @@
 
 #include "ttable.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <iostream>
 
 #include "Board.hpp"
 #include "makemove.hpp"
 #include "moveio.hpp"
+#include "sharedhash.hpp"
 
 // std::string ascii_flags[] = { "None", "Alpha", "Beta", "Exact" };
 
-int probe_PV_move(const Board& pos, const HashTable& table) {
+/*
+    Entry access
+*/
+
+static inline uint64_t pack_data(const HashData& data) {
+    return static_cast<uint64_t>(data.move) |
+           static_cast<uint64_t>(static_cast<uint16_t>(data.score)) << 16 |
+           static_cast<uint64_t>(data.depth) << 32 |
+           static_cast<uint64_t>(data.flags) << 40 |
+           static_cast<uint64_t>(data.age) << 48;
+}
+
+static inline HashData unpack_data(uint64_t data) {
+    return {static_cast<Move>(data), static_cast<int16_t>(data >> 16),
+            static_cast<uint8_t>(data >> 32), static_cast<uint8_t>(data >> 40),
+            static_cast<uint16_t>(data >> 48)};
+}
+
+// Reads an entry into data; false if it does not hold the position (or was torn by a writer)
+static inline bool read_entry(HashEntry& entry, uint64_t hash_key, HashData& data) {
+    const uint64_t stored_key =
+        std::atomic_ref<uint64_t>(entry.hash_key).load(std::memory_order_relaxed);
+    const uint64_t stored_data =
+        std::atomic_ref<uint64_t>(entry.data).load(std::memory_order_relaxed);
+    if ((stored_key ^ stored_data) != hash_key) {
+        return false;
+    }
+    data = unpack_data(stored_data);
+    return true;
+}
+
+static inline void write_entry(HashEntry& entry, uint64_t hash_key, const HashData& data) {
+    const uint64_t packed = pack_data(data);
+    std::atomic_ref<uint64_t>(entry.hash_key).store(hash_key ^ packed, std::memory_order_relaxed);
+    std::atomic_ref<uint64_t>(entry.data).store(packed, std::memory_order_relaxed);
+}
+
+Move probe_PV_move(const Board& pos, const HashTable& table) {
     // Prevent division-by-zero
     if (table.max_entries == 0 || table.pTable == nullptr) {
         return NO_MOVE;
     }
 
-    int index = pos.hash_key % table.max_entries;
+    uint64_t index = pos.hash_key % table.max_entries;
+    HashData data;
 
-    if (table.pTable[index].hash_key == pos.hash_key) {
-        // std::cout << "Probed entry index " << index << " with depth " <<
-        // (int)table.pTable[index].depth << "\n";
-        return table.pTable[index].move;
+    if (read_entry(table.pTable[index], pos.hash_key, data)) {
+        return data.move;
     }
 
     return NO_MOVE;
@@ -30,24 +69,55 @@ int probe_PV_move(const Board& pos, const HashTable& table) {
 
 // Fills the PV by iteratively probing TT
 // Should only be used as a fallback option - not as reliable as tracking PV via extraction
-void get_PV_line(Board& pos, const HashTable& table, const uint8_t depth) {
-    int move = probe_PV_move(pos, table);
+void get_PV_line(Board& pos, UndoStack& undo, const HashTable& table, PVLine& line,
+                 const uint8_t depth) {
+    Move move = probe_PV_move(pos, table);
     int count = 0;
 
     // Try the moves of the stored PV to see if they are legal
     while (move != NO_MOVE && count < depth) {
-        if (move_exists(pos, move)) {
-            make_move(pos, move);
-            pos.PV_array.moves[count++] = move;
+        if (move_exists(pos, undo, move)) {
+            make_move(pos, undo, move);
+            line.moves[count++] = move;
         } else {
             break;
         }
         move = probe_PV_move(pos, table);
     }
-    pos.PV_array.length = count;
+    line.length = count;
 
     while (pos.ply > 0) {
-        take_move(pos);
+        take_move(pos, undo);
+    }
+}
+
+// Permill of the table written in this search, sampled from its first 1000 entries
+int hashfull(const HashTable& table) {
+    if (table.pTable == nullptr || table.max_entries == 0) {
+        return 0;
+    }
+
+    const uint64_t samples = std::min<uint64_t>(1000, table.max_entries);
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < samples; ++i) {
+        const uint64_t stored_data =
+            std::atomic_ref<uint64_t>(table.pTable[i].data).load(std::memory_order_relaxed);
+        const HashData data = unpack_data(stored_data);
+        if (data.flags != HFNONE && data.age == table.table_age) {
+            used++;
+        }
+    }
+    return static_cast<int>(used * 1000 / samples);
+}
+
+// A new search makes the entries of the earlier ones old. Engines sharing a table share its age
+// too, so that they agree on which entries are old
+void age_hash_table(HashTable& table) {
+    if (table.shared_age != nullptr) {
+        table.table_age =
+            std::atomic_ref<uint16_t>(*table.shared_age).fetch_add(1, std::memory_order_relaxed) + 1;
+    } else {
+        table.table_age++;
     }
 }
 
@@ -56,22 +126,22 @@ void clear_hash_table(HashTable& table) {
         return;
     }
 
-    for (uint64_t i = 0; i < table.max_entries; ++i) {
-        table.pTable[i] = HashEntry();
+    // Other processes are searching with a shared table
+    if (table.shared == nullptr) {
+        for (uint64_t i = 0; i < table.max_entries; ++i) {
+            table.pTable[i] = HashEntry();
+        }
     }
     table.num_entries = 0;
     table.new_write = 0;
     table.table_age = 0;
 }
 
-void init_hash_table(HashTable& table, const uint16_t MB) {
+void init_hash_table(HashTable& table, const uint32_t MB) {
     // Free exisitng table if present
-    if (table.pTable != nullptr) {
-        delete[] table.pTable;
-        table.pTable = nullptr;
-    }
+    free_hash_table(table);
 
-    uint16_t trying_size = MB;
+    uint32_t trying_size = MB;
 
     // Iteratively retry with smaller sizes if allocation fails
     while (trying_size >= MIN_HASH) {
@@ -96,24 +166,37 @@ void init_hash_table(HashTable& table, const uint16_t MB) {
     return;
 }
 
-bool probe_hash_entry(Board& pos, HashTable& table, int& move, int& score, int alpha, int beta,
+void free_hash_table(HashTable& table) {
+    if (table.shared != nullptr) {
+        detach_shared_hash_table(table);
+        return;
+    }
+
+    delete[] table.pTable;
+    table.pTable = nullptr;
+    table.max_entries = 0;
+    table.num_entries = 0;
+}
+
+bool probe_hash_entry(Board& pos, HashTable& table, Move& move, int& score, int alpha, int beta,
                       int& entry_depth, int depth) {
-    int index = pos.hash_key % table.max_entries;
+    uint64_t index = pos.hash_key % table.max_entries;
+    HashData data;
 
-    if (table.pTable[index].hash_key == pos.hash_key) {
-        move = table.pTable[index].move;
-        entry_depth = table.pTable[index].depth;
+    if (read_entry(table.pTable[index], pos.hash_key, data)) {
+        move = data.move;
+        entry_depth = data.depth;
         if (entry_depth >= depth) {
             table.hit++;
 
-            score = table.pTable[index].score;
+            score = data.score;
             if (score > MATE_SCORE)
                 score -= pos.ply;
             else if (score < -MATE_SCORE)
                 score += pos.ply;
 
             // Transposition table cutoffs
-            switch (table.pTable[index].flags) {
+            switch (data.flags) {
                 case HFALPHA:
                     if (score <= alpha) {
                         return true;
@@ -134,23 +217,34 @@ bool probe_hash_entry(Board& pos, HashTable& table, int& move, int& score, int a
     return false;
 }
 
-void store_hash_entry(Board& pos, HashTable& table, const int move, int score, const uint8_t flags,
+void store_hash_entry(Board& pos, HashTable& table, const Move move, int score, const uint8_t flags,
                       const uint8_t depth) {
-    int index = pos.hash_key % table.max_entries;
-    HashEntry* entry = &table.pTable[index];
-    const int age_delta = table.table_age - entry->age;
+    uint64_t index = pos.hash_key % table.max_entries;
+    HashEntry& entry = table.pTable[index];
+    HashData data;
+
+    if (read_entry(entry, pos.hash_key, data)) {
+        const int age_delta = table.table_age - data.age;
+        const int replace = age_delta > 0 ||
+                             depth + 4 > data.depth ||
+                             flags == HFEXACT;
+
+        if (!replace) {
+            // No need to overwrite the entry, but keep the newest move
+            if (move && move != data.move) {
+                data.move = move;
+                write_entry(entry, pos.hash_key, data);
+            }
+            return;
+        }
 
-    if (move || (entry->hash_key != pos.hash_key)) {
-        entry->move = move;
+        if (move) {
+            data.move = move;
+        }
+    } else {
+        data.move = move;
     }
 
-    const int replace = (entry->hash_key != pos.hash_key) ||
-                         age_delta > 0 ||
-                         depth + 4 > entry->depth ||
-                         flags == HFEXACT;
-
-    if (!replace) return;  // No need to overwrite the entry
-
     table.new_write++;
     table.num_entries++;
 
@@ -159,13 +253,11 @@ void store_hash_entry(Board& pos, HashTable& table, const int move, int score, c
     else if (score < -MATE_SCORE)
         score -= pos.ply;
 
-    entry->hash_key = pos.hash_key;
-    entry->flags = flags;
-    entry->score = score;
-    entry->depth = depth;
-    entry->age = table.table_age;
-    // std::cout << "Storing move | Index: " << index << " Move: " << print_move(entry->move) << "
-    // Score: " << entry->score << " Depth: " << (int)entry->depth << "\n";
+    data.flags = flags;
+    data.score = static_cast<int16_t>(score);
+    data.depth = depth;
+    data.age = table.table_age;
+    write_entry(entry, pos.hash_key, data);
 }
 
 // Function prototype
@@ -15,15 +15,21 @@ const uint16_t MIN_HASH = 1;
 // Hash entry flags
 enum { HFNONE, HFALPHA, HFBETA, HFEXACT };
 
-// Hash entry struct
-// 20 bytes (will be padded to 24)
+// Hash entry contents (scores are bounded by INF_BOUND and fit in 16 bits)
 typedef struct {
-    uint64_t hash_key;
-    int move;
-    int score;
+    Move move;
+    int16_t score;
     uint8_t depth;
     uint8_t flags;
     uint16_t age;  // indicates how new an entry is
+} HashData;
+
+// Hash entry struct
+// 16 bytes: HashData packed into one word, and the position key xor'd with it. Threads sharing
+// a table read and write the two words without locks; a torn entry fails the key check.
+typedef struct {
+    uint64_t hash_key;  // Position key ^ data
+    uint64_t data;
 } HashEntry;
 
 /*
@@ -32,27 +38,35 @@ typedef struct {
 } HashBucket;
 */
 
+struct SharedHashMapping;  // See sharedhash.cpp
+
 // Hash table struct
 typedef struct {
     HashEntry* pTable;
+    SharedHashMapping* shared;  // Shared-memory segment holding pTable (nullptr: private table)
     uint64_t max_entries;  // maximum entries based on given hash size
-    uint64_t num_entries;  // number of entries at any given time
+    uint64_t num_entries;  // writes since the table was cleared (see hashfull for usage)
     int new_write;
     int overwrite;
     int hit;  // tracks the number of entries probed
     int cut;  // max number of probes allowed before hash table is full (to avoid collision of
               // entries)
     uint16_t table_age;  // increments every move
+    uint16_t* shared_age;  // Age counter of the engines sharing the table (nullptr: table_age)
 } HashTable;
 
 // Functions
-int probe_PV_move(const Board& pos, const HashTable& table);
-void get_PV_line(Board& pos, const HashTable& table, const uint8_t depth);
+Move probe_PV_move(const Board& pos, const HashTable& table);
+void get_PV_line(Board& pos, UndoStack& undo, const HashTable& table, PVLine& line,
+                 const uint8_t depth);
+int hashfull(const HashTable& table);
+void age_hash_table(HashTable& table);
 void clear_hash_table(HashTable& table);
-void init_hash_table(HashTable& table, const uint16_t MB);
-bool probe_hash_entry(Board& pos, HashTable& table, int& move, int& score, int alpha, int beta,
+void init_hash_table(HashTable& table, const uint32_t MB);
+void free_hash_table(HashTable& table);
+bool probe_hash_entry(Board& pos, HashTable& table, Move& move, int& score, int alpha, int beta,
                       int& entry_depth, int depth);
-void store_hash_entry(Board& pos, HashTable& table, const int move, int score, const uint8_t flags,
+void store_hash_entry(Board& pos, HashTable& table, const Move move, int score, const uint8_t flags,
                       const uint8_t depth);
 
 #endif  // TTABLE_HPP
\ No newline at end of file